@@ -10,7 +10,9 @@
 
 #include "queryosity/dataset_reader.hpp"
 
+#include "queryosity/column_batch_definition.hpp"
 #include "queryosity/column_definition.hpp"
+#include "queryosity/column_inplace_definition.hpp"
 #include "queryosity/column_equation.hpp"
 #include "queryosity/column_reader.hpp"
 #include "queryosity/column_series.hpp"
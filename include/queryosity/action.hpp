@@ -14,8 +14,20 @@ namespace queryosity {
  * 1. `vary()` immediately after the instantiation of an action (if it is not
  * nominal).
  * 2. `initialize()` before entering the entry loop.
- * 3. `execute()` for each entry.
+ * 3. `execute()` for each entry (or `execute_batch()` for each block of
+ * entries, see below). Columns that do not override it are skipped, as their
+ * cached values are invalidated through the epoch of their slot instead.
  * 4. `finalize()` after exiting the entry loop.
+ *
+ * When the dataflow is processed in blocks of entries (see
+ * `dataset::batch`), an action that `is_batched()` is executed once per block
+ * through `execute_batch()`, ahead of the per-entry `execute()` of all other
+ * actions over the same block. Therefore, it must only depend on other
+ * batched actions, except for a `column::batch_definition`, whose inputs are
+ * gathered entry-by-entry beforehand: any other that reads from an unbatched
+ * source is rejected when the dataflow is processed. If all of the first
+ * selections of the dataflow are decided for a block this way, `execute()` is
+ * only called for the entries of the block that pass one of them.
  */
 class action {
 
@@ -48,6 +60,25 @@ public:
    */
   virtual void execute(unsigned int slot, unsigned long long entry) = 0;
 
+  /**
+   * @brief Execute the action over a block of entries.
+   * @param[in] slot The thread slot index.
+   * @param[in] begin First `entry` of the block.
+   * @param[in] end Last `entry - 1` of the block.
+   * @details By default, the action is executed for each entry in the block,
+   * without the epoch of the slot being advanced: the columns it reads must be
+   * batched as well.
+   */
+  virtual void execute_batch(unsigned int slot, unsigned long long begin,
+                             unsigned long long end);
+
+  /**
+   * @brief Whether the action should be executed one block at a time, if
+   * enabled.
+   * @return `false` by default.
+   */
+  virtual bool is_batched() const;
+
   /**
    * @brief Finalize the action.
    * @param[in] slot The thread slot index.
@@ -57,4 +88,14 @@ public:
 
 } // namespace queryosity
 
-inline void queryosity::action::vary(const std::string &) {}
\ No newline at end of file
+inline void queryosity::action::vary(const std::string &) {}
+
+inline void queryosity::action::execute_batch(unsigned int slot,
+                                              unsigned long long begin,
+                                              unsigned long long end) {
+  for (auto entry = begin; entry < end; ++entry) {
+    this->execute(slot, entry);
+  }
+}
+
+inline bool queryosity::action::is_batched() const { return false; }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace queryosity {
+
+/**
+ * @brief Contiguous storage of the actions of a slot.
+ * @details Objects are placed one after another in creation order, into blocks
+ * that are allocated as needed. They are destroyed in reverse order, and the
+ * blocks freed all at once, when the arena is destroyed.
+ */
+class arena {
+
+public:
+  arena(size_t block_size = 64 * 1024);
+  ~arena();
+
+  arena(arena const &) = delete;
+  arena &operator=(arena const &) = delete;
+
+  /**
+   * @brief Construct an object in the arena.
+   * @param[in] args Constructor arguments.
+   * @return Pointer to the object, valid for the lifetime of the arena.
+   */
+  template <typename T, typename... Args> T *make(Args &&...args);
+
+  /**
+   * @brief Take ownership of an object allocated elsewhere.
+   * @param[in] obj Object to be destroyed along with the arena.
+   */
+  template <typename T> T *adopt(std::unique_ptr<T> obj);
+
+protected:
+  void *allocate(size_t size, size_t alignment);
+
+  template <typename T> static void destroy(void *obj);
+  template <typename T> static void release(void *obj);
+
+protected:
+  struct block {
+    std::byte *data;
+    std::align_val_t alignment;
+  };
+
+protected:
+  size_t m_block_size;
+  std::vector<block> m_blocks;
+  size_t m_used;
+  std::vector<std::pair<void *, void (*)(void *)>> m_destructors;
+};
+
+} // namespace queryosity
+
+inline queryosity::arena::arena(size_t block_size)
+    : m_block_size(block_size), m_used(block_size) {}
+
+inline queryosity::arena::~arena() {
+  for (auto it = m_destructors.rbegin(); it != m_destructors.rend(); ++it) {
+    it->second(it->first);
+  }
+  for (auto const &blk : m_blocks) {
+    ::operator delete(blk.data, blk.alignment);
+  }
+}
+
+template <typename T, typename... Args>
+T *queryosity::arena::make(Args &&...args) {
+  auto mem = this->allocate(sizeof(T), alignof(T));
+  if constexpr (std::is_trivially_destructible_v<T>) {
+    return new (mem) T(std::forward<Args>(args)...);
+  } else {
+    // the destructor is registered first, such that a constructed object is
+    // never left without it
+    m_destructors.emplace_back(mem, &arena::destroy<T>);
+    try {
+      return new (mem) T(std::forward<Args>(args)...);
+    } catch (...) {
+      m_destructors.pop_back();
+      throw;
+    }
+  }
+}
+
+template <typename T> T *queryosity::arena::adopt(std::unique_ptr<T> obj) {
+  auto out = obj.get();
+  m_destructors.emplace_back(out, &arena::release<T>);
+  obj.release();
+  return out;
+}
+
+inline void *queryosity::arena::allocate(size_t size, size_t alignment) {
+  // objects are never split across blocks
+  auto offset = (m_used + alignment - 1) / alignment * alignment;
+  if (m_blocks.empty() || offset + size > m_block_size ||
+      alignment > static_cast<size_t>(m_blocks.back().alignment)) {
+    // larger or more aligned objects get a block of their own, after which the
+    // current block can no longer be used
+    const auto align = std::align_val_t{
+        std::max(alignment, alignof(std::max_align_t))};
+    const auto nbytes = std::max(size, m_block_size);
+    m_blocks.push_back(
+        {static_cast<std::byte *>(::operator new(nbytes, align)), align});
+    offset = 0;
+  }
+  m_used = offset + size;
+  return m_blocks.back().data + offset;
+}
+
+template <typename T> void queryosity::arena::destroy(void *obj) {
+  static_cast<T *>(obj)->~T();
+}
+
+template <typename T> void queryosity::arena::release(void *obj) {
+  delete static_cast<T *>(obj);
+}
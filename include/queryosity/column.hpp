@@ -2,7 +2,11 @@
 
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <vector>
 
 #include "action.hpp"
 
@@ -13,10 +17,35 @@ namespace queryosity {
  */
 namespace column {
 
+/**
+ * @brief Entry being processed by a slot, shared by all of its columns.
+ * @details The epoch is advanced once for each entry, which invalidates the
+ * values cached by the columns all at once (and reclaims the scratch memory of
+ * the slot).
+ */
+struct epoch {
+  unsigned int slot = 0;
+  unsigned long long entry = 0;
+  unsigned long long count = 0;
+  std::pmr::memory_resource *scratch = nullptr;
+};
+
 class node : public action {
 public:
   node() = default;
   virtual ~node() = default;
+
+  void set_epoch(epoch const *ep);
+
+  /**
+   * @brief Scratch memory for temporaries needed to compute the value.
+   * @details Memory allocated from it is only valid until the next entry, at
+   * which point it is reclaimed all at once instead of being freed.
+   */
+  std::pmr::memory_resource *get_scratch() const;
+
+protected:
+  epoch const *m_epoch = nullptr;
 };
 
 //---------------------------------------------------
@@ -48,7 +77,7 @@ template <typename From>
 class view<To>::converted_from : public view<To> {
 
 public:
-  converted_from(view<From> const &from);
+  converted_from(view<From> const &from, epoch const *ep = nullptr);
   virtual ~converted_from() = default;
 
 public:
@@ -57,6 +86,9 @@ public:
 private:
   view<From> const *m_from;
   mutable To m_converted_from;
+  // converted once per entry if the epoch is known, on every call otherwise
+  epoch const *m_epoch;
+  mutable unsigned long long m_updated;
 };
 
 //------------------------------------------
@@ -90,13 +122,25 @@ public:
                           unsigned long long end) override;
   virtual void execute(unsigned int slot, unsigned long long entry) override;
   virtual void finalize(unsigned int slot) override;
+
+  /**
+   * @brief Value of the column converted to another type.
+   * @details The conversion is shared by all consumers of the column that
+   * require it, and performed at most once per entry.
+   */
+  template <typename To> view<To> const &converted() const;
+
+protected:
+  // type-erased conversions, keyed by their value type
+  mutable std::vector<std::pair<std::type_index, std::shared_ptr<void>>>
+      m_conversions;
 };
 
 // costly to move around
 template <typename T> class variable {
 
 public:
-  variable() = default;
+  variable();
   template <typename U> variable(view<U> const &val);
   ~variable() = default;
 
@@ -107,7 +151,9 @@ public:
   T const *field() const;
 
 protected:
-  std::unique_ptr<const view<T>> m_view;
+  // only needed if the column is not of the same type
+  std::unique_ptr<const view<T>> m_converted;
+  view<T> const *m_view;
 };
 
 /**
@@ -163,9 +209,13 @@ template <typename> class calculation;
 
 template <typename> class definition;
 
+template <typename> class inplace_definition;
+
+template <typename> class batch_definition;
+
 template <typename, typename U> class conversion;
 
-template <typename> class equation;
+template <typename, typename = void> class equation;
 
 template <typename> class composition;
 
@@ -194,6 +244,11 @@ constexpr std::true_type
 check_definition(typename column::definition<T> const &);
 constexpr std::false_type check_definition(...);
 
+template <typename T>
+constexpr std::true_type
+check_batch_definition(typename column::batch_definition<T> const &);
+constexpr std::false_type check_batch_definition(...);
+
 template <typename T>
 constexpr std::true_type check_equation(typename column::equation<T> const &);
 constexpr std::false_type check_equation(...);
@@ -215,6 +270,10 @@ template <typename T>
 constexpr bool is_definition_v =
     decltype(check_definition(std::declval<std::decay_t<T> const &>()))::value;
 
+template <typename T>
+constexpr bool is_batch_definition_v = decltype(check_batch_definition(
+    std::declval<std::decay_t<T> const &>()))::value;
+
 template <typename T>
 constexpr bool is_equation_v =
     decltype(check_equation(std::declval<std::decay_t<T> const &>()))::value;
@@ -243,12 +302,19 @@ using value_t = std::decay_t<decltype(std::declval<T>().value())>;
 template <typename Ret, typename... Obs>
 struct deduce_equation<std::function<Ret(Obs...)>> {
   using type = column::equation<std::decay_t<Ret>(column::value_t<Obs>...)>;
+  template <typename Fn>
+  using inlined_type =
+      column::equation<std::decay_t<Ret>(column::value_t<Obs>...), Fn>;
 };
 
 template <typename Fn>
 using equation_t = typename deduce_equation<
     typename column::expression<Fn>::function_type>::type;
 
+template <typename Fn>
+using inline_equation_t = typename deduce_equation<
+    typename column::expression<Fn>::function_type>::template inlined_type<Fn>;
+
 template <typename T> using evaluated_t = typename T::evaluated_type;
 
 } // namespace column
@@ -258,6 +324,17 @@ constexpr bool is_column_v = std::is_base_of_v<column::node, T>;
 
 } // namespace queryosity
 
+inline void queryosity::column::node::set_epoch(epoch const *ep) {
+  m_epoch = ep;
+}
+
+inline std::pmr::memory_resource *
+queryosity::column::node::get_scratch() const {
+  if (m_epoch && m_epoch->scratch)
+    return m_epoch->scratch;
+  return std::pmr::get_default_resource();
+}
+
 template <typename T>
 void queryosity::column::valued<T>::initialize(unsigned int, unsigned long long,
                                                unsigned long long) {}
@@ -268,6 +345,21 @@ void queryosity::column::valued<T>::execute(unsigned int, unsigned long long) {}
 template <typename T>
 void queryosity::column::valued<T>::finalize(unsigned int) {}
 
+template <typename T>
+template <typename To>
+queryosity::column::view<To> const &
+queryosity::column::valued<T>::converted() const {
+  using conversion_type = typename view<To>::template converted_from<T>;
+  const auto key = std::type_index(typeid(To));
+  for (auto const &[type, cnv] : m_conversions) {
+    if (type == key)
+      return *static_cast<conversion_type const *>(cnv.get());
+  }
+  auto cnv = std::make_shared<conversion_type>(*this, this->m_epoch);
+  m_conversions.emplace_back(key, cnv);
+  return *cnv;
+}
+
 template <typename T> T const *queryosity::column::view<T>::field() const {
   return &this->value();
 }
@@ -275,13 +367,18 @@ template <typename T> T const *queryosity::column::view<T>::field() const {
 template <typename To>
 template <typename From>
 queryosity::column::view<To>::converted_from<From>::converted_from(
-    view<From> const &from)
-    : m_from(&from) {}
+    view<From> const &from, epoch const *ep)
+    : m_from(&from), m_converted_from(), m_epoch(ep),
+      m_updated(ep ? ep->count - 1 : 0) {}
 
 template <typename To>
 template <typename From>
 const To &queryosity::column::view<To>::converted_from<From>::value() const {
-  m_converted_from = std::move(m_from->value());
+  if (!m_epoch || m_updated != m_epoch->count) {
+    m_converted_from = m_from->value();
+    if (m_epoch)
+      m_updated = m_epoch->count;
+  }
   return m_converted_from;
 }
 
@@ -318,10 +415,27 @@ queryosity::column::view_as(view<From> const &from) {
 // variable
 // --------
 
+template <typename T>
+queryosity::column::variable<T>::variable()
+    : m_converted(), m_view(nullptr) {}
+
 template <typename T>
 template <typename U>
 queryosity::column::variable<T>::variable(view<U> const &val)
-    : m_view(view_as<T>(val)) {}
+    : m_converted(), m_view(nullptr) {
+  if constexpr (std::is_same_v<T, U>) {
+    m_view = &val;
+  } else if constexpr (std::is_base_of_v<T, U>) {
+    m_converted = view_as<T>(val);
+    m_view = m_converted.get();
+  } else if (auto col = dynamic_cast<valued<U> const *>(&val)) {
+    // share the conversion of a column with its other consumers
+    m_view = &col->template converted<T>();
+  } else {
+    m_converted = view_as<T>(val);
+    m_view = m_converted.get();
+  }
+}
 
 template <typename T> T const &queryosity::column::variable<T>::value() const {
   return m_view->value();
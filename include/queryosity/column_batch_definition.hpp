@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+#include "column.hpp"
+
+namespace queryosity {
+
+namespace column {
+
+/**
+ * @brief Contiguous values of a column over a block of entries.
+ * @tparam T Value type (`const`-qualified for inputs).
+ * @details A pointer and a size, like a C++20 `std::span` (which can be made
+ * from `data()` and `size()`).
+ */
+template <typename T> class span {
+
+public:
+  span(T *data, size_t size) : m_data(data), m_size(size) {}
+
+  T *data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool empty() const { return !m_size; }
+
+  T &operator[](size_t i) const { return m_data[i]; }
+  T *begin() const { return m_data; }
+  T *end() const { return m_data + m_size; }
+
+protected:
+  T *m_data;
+  size_t m_size;
+};
+
+/**
+ * @brief Outputs of a column over the last block of entries, as the decisions
+ * of a cut.
+ */
+class block_decisions {
+
+public:
+  block_decisions() = default;
+  virtual ~block_decisions() = default;
+
+  /**
+   * @brief Set the bits of the entries whose output is non-zero.
+   * @param[in] begin First entry of the block.
+   * @param[in] end Entry past the last one of the block.
+   * @param[out] mask One bit per entry of the block, all unset beforehand.
+   */
+  virtual void decide(unsigned long long begin, unsigned long long end,
+                      std::uint64_t *mask) const = 0;
+};
+
+} // namespace column
+
+/**
+ * @ingroup abc
+ * @brief Column with user-defined return value type, evaluated over blocks of
+ * entries at a time.
+ * @tparam Out Output data type.
+ * @tparam Ins Input column data type(s).
+ * @details When the dataflow is processed in blocks of entries (see
+ * `dataset::batch`), the values of the input columns are collected over each
+ * block and passed to `evaluate()` all at once as contiguous spans, such that
+ * the computation can be vectorized. Its inputs and outputs may be any other
+ * column, whether it is evaluated entry-by-entry or in blocks. Otherwise, it is
+ * evaluated for one entry at a time with spans of size one.
+ */
+template <typename Out, typename... Ins>
+class column::batch_definition<Out(Ins...)> : public column::valued<Out>,
+                                              public column::block_decisions {
+
+public:
+  using vartuple_type = std::tuple<variable<Ins>...>;
+
+public:
+  batch_definition();
+  virtual ~batch_definition() = default;
+
+public:
+  virtual const Out &value() const final override;
+
+  /**
+   * @brief Compute the quantity of interest for a block of entries.
+   * @param[out] out Output values, one for each entry.
+   * @param[in] args Input column values, one for each entry.
+   */
+  virtual void evaluate(span<Out> out, span<Ins const>... args) const = 0;
+
+  virtual void initialize(unsigned int slot, unsigned long long begin,
+                          unsigned long long end) override;
+  virtual void execute_batch(unsigned int slot, unsigned long long begin,
+                             unsigned long long end) override;
+  virtual bool is_batched() const final override;
+  virtual void finalize(unsigned int slot) override;
+
+  virtual void decide(unsigned long long begin, unsigned long long end,
+                      std::uint64_t *mask) const final override;
+
+  /**
+   * @brief Collect the values of the input columns for an entry of the block
+   * to be executed next.
+   */
+  void gather(unsigned int slot, unsigned long long entry);
+
+  template <typename... Args> void set_arguments(const view<Args> &...args);
+
+protected:
+  // contiguous storage that can grow (including for bool)
+  template <typename T> struct buffer {
+    std::unique_ptr<T[]> data;
+    size_t size = 0;
+    size_t capacity = 0;
+    void resize(size_t n);
+  };
+
+protected:
+  vartuple_type m_arguments;
+  std::tuple<buffer<Ins>...> m_inputs;
+  buffer<Out> m_outputs;
+  size_t m_ngathered;
+  unsigned long long m_begin;
+  unsigned long long m_end;
+  mutable Out m_value;
+  mutable unsigned long long m_updated;
+};
+
+} // namespace queryosity
+
+template <typename Out, typename... Ins>
+queryosity::column::batch_definition<Out(Ins...)>::batch_definition()
+    : m_ngathered(0), m_begin(0), m_end(0), m_value(), m_updated(0) {}
+
+template <typename Out, typename... Ins>
+template <typename... Args>
+void queryosity::column::batch_definition<Out(Ins...)>::set_arguments(
+    view<Args> const &...args) {
+  static_assert(sizeof...(Ins) == sizeof...(Args));
+  m_arguments = std::make_tuple(std::invoke(
+      [](const view<Args> &args) -> variable<Ins> {
+        return variable<Ins>(args);
+      },
+      args)...);
+}
+
+template <typename Out, typename... Ins>
+template <typename T>
+void queryosity::column::batch_definition<Out(Ins...)>::buffer<T>::resize(
+    size_t n) {
+  if (n > capacity) {
+    auto grown = std::make_unique<T[]>(std::max(n, 2 * capacity));
+    std::copy(data.get(), data.get() + size, grown.get());
+    data = std::move(grown);
+    capacity = std::max(n, 2 * capacity);
+  }
+  size = n;
+}
+
+template <typename Out, typename... Ins>
+const Out &queryosity::column::batch_definition<Out(Ins...)>::value() const {
+  // entry of the last block evaluated
+  assert(this->m_epoch);
+  const auto entry = this->m_epoch->entry;
+  if (entry >= m_begin && entry < m_end)
+    return m_outputs.data[entry - m_begin];
+  // otherwise, evaluate this entry alone
+  if (m_updated != this->m_epoch->count) {
+    std::apply(
+        [this](const variable<Ins> &...args) {
+          this->evaluate(span<Out>(&m_value, 1),
+                         span<Ins const>(&args.value(), 1)...);
+        },
+        m_arguments);
+    m_updated = this->m_epoch->count;
+  }
+  return m_value;
+}
+
+template <typename Out, typename... Ins>
+void queryosity::column::batch_definition<Out(Ins...)>::initialize(
+    unsigned int, unsigned long long, unsigned long long) {
+  m_ngathered = 0;
+  m_begin = 0;
+  m_end = 0;
+}
+
+template <typename Out, typename... Ins>
+void queryosity::column::batch_definition<Out(Ins...)>::gather(
+    unsigned int, unsigned long long) {
+  const auto igathered = m_ngathered++;
+  std::apply(
+      [this, igathered](const variable<Ins> &...args) {
+        std::apply(
+            [igathered, &args...](buffer<Ins> &...inputs) {
+              ((inputs.resize(igathered + 1),
+                inputs.data[igathered] = args.value()),
+               ...);
+            },
+            m_inputs);
+      },
+      m_arguments);
+}
+
+template <typename Out, typename... Ins>
+void queryosity::column::batch_definition<Out(Ins...)>::execute_batch(
+    unsigned int, unsigned long long begin, unsigned long long end) {
+  // the block must have been gathered entry-by-entry beforehand
+  const auto nentries = static_cast<size_t>(end - begin);
+  if (m_ngathered != nentries)
+    throw std::logic_error("inputs of batch definition not gathered");
+  m_outputs.resize(nentries);
+  std::apply(
+      [this, nentries](buffer<Ins> &...inputs) {
+        this->evaluate(span<Out>(m_outputs.data.get(), nentries),
+                       span<Ins const>(inputs.data.get(), nentries)...);
+      },
+      m_inputs);
+  m_ngathered = 0;
+  m_begin = begin;
+  m_end = end;
+}
+
+template <typename Out, typename... Ins>
+bool queryosity::column::batch_definition<Out(Ins...)>::is_batched() const {
+  return true;
+}
+
+template <typename Out, typename... Ins>
+void queryosity::column::batch_definition<Out(Ins...)>::decide(
+    unsigned long long begin, unsigned long long end,
+    std::uint64_t *mask) const {
+  // only a column that converts to double can be the decision of a cut
+  if constexpr (std::is_convertible_v<Out const &, double>) {
+    assert(begin == m_begin && end == m_end);
+    auto const out = m_outputs.data.get();
+    for (size_t i = 0; i < static_cast<size_t>(end - begin); ++i) {
+      mask[i / 64] |= std::uint64_t(static_cast<double>(out[i]) != 0)
+                      << (i % 64);
+    }
+  } else {
+    (void)begin;
+    (void)end;
+    (void)mask;
+  }
+}
+
+template <typename Out, typename... Ins>
+void queryosity::column::batch_definition<Out(Ins...)>::finalize(
+    unsigned int) {
+  m_begin = 0;
+  m_end = 0;
+}
@@ -8,7 +8,8 @@ namespace queryosity {
  * @brief Calculate a column value for each dataset entry.
  * @tparam Val Column value type.
  * @details A calculation is performed once per-entry (if needed) and its value
- * is stored for multiple accesses by downstream actions within the entry.
+ * is stored for multiple accesses by downstream actions within the entry, i.e.
+ * until the epoch of its slot advances (on every access if it has none).
  * The type `Val` must be *CopyConstructible* and *CopyAssignable*.
  */
 template <typename Val> class column::calculation : public valued<Val> {
@@ -22,6 +23,15 @@ public:
 
   virtual Val calculate() const = 0;
 
+  /**
+   * @brief Calculate the value in-place.
+   * @param[in,out] out Stored value, as calculated for a previous entry.
+   * @details By default, the value is assigned from `calculate()`. Overriding
+   * this method allows the storage of the previous value, e.g. the capacity of
+   * a container, to be re-used.
+   */
+  virtual void calculate_into(Val &out) const;
+
   virtual void initialize(unsigned int slot, unsigned long long begin,
                           unsigned long long end) override;
   virtual void execute(unsigned int slot, unsigned long long entry) override;
@@ -33,31 +43,39 @@ protected:
 
 protected:
   mutable Val m_value;
-  mutable bool m_updated;
+  mutable unsigned long long m_updated;
 };
 
 } // namespace queryosity
 
 template <typename Val>
 queryosity::column::calculation<Val>::calculation()
-    : m_value(), m_updated(false) {}
+    : m_value(), m_updated(0) {}
 
 template <typename Val>
 const Val &queryosity::column::calculation<Val>::value() const {
-  if (!m_updated)
+  // without an epoch, the value is calculated on every call
+  if (!this->m_epoch || m_updated != this->m_epoch->count)
     this->update();
   return m_value;
 }
 
 template <typename Val>
 void queryosity::column::calculation<Val>::update() const {
-  m_value = std::move(this->calculate());
-  m_updated = true;
+  this->calculate_into(m_value);
+  if (this->m_epoch)
+    m_updated = this->m_epoch->count;
+}
+
+template <typename Val>
+void queryosity::column::calculation<Val>::calculate_into(Val &out) const {
+  out = this->calculate();
 }
 
 template <typename Val>
 void queryosity::column::calculation<Val>::reset() const {
-  m_updated = false;
+  if (this->m_epoch)
+    m_updated = this->m_epoch->count - 1;
 }
 
 template <typename Val>
@@ -67,9 +85,7 @@ void queryosity::column::calculation<Val>::initialize(unsigned int,
 
 template <typename Val>
 void queryosity::column::calculation<Val>::execute(unsigned int,
-                                                   unsigned long long) {
-  this->reset();
-}
+                                                   unsigned long long) {}
 
 template <typename Val>
 void queryosity::column::calculation<Val>::finalize(unsigned int) {}
\ No newline at end of file
@@ -1,12 +1,20 @@
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "arena.hpp"
 #include "column.hpp"
+#include "column_operation.hpp"
 #include "dataset.hpp"
+#include "scratch.hpp"
 
 namespace queryosity {
 
@@ -14,6 +22,17 @@ namespace column {
 
 class computation {
 
+public:
+  /**
+   * @brief Gather the inputs of an action for an entry.
+   */
+  using execute_t = void (*)(action *, unsigned int, unsigned long long);
+
+  /**
+   * @brief Set whether a fused column is read by more than one action.
+   */
+  using share_t = void (*)(action *, bool);
+
 public:
   computation() = default;
   virtual ~computation() = default;
@@ -23,7 +42,8 @@ public:
   auto read(dataset::reader<DS> &ds, unsigned int slot, const std::string &name)
       -> read_column_t<DS, Val> *;
 
-  template <typename Val> auto assign(Val const &val) -> fixed<Val> *;
+  template <typename Val>
+  auto assign(std::shared_ptr<const Val> const &val) -> fixed<Val> *;
 
   template <typename To, typename Col>
   auto convert(Col const &col) -> conversion<To, value_t<Col>> *;
@@ -35,14 +55,76 @@ public:
   auto equate(std::function<Ret(Obs...)> fn) const -> std::unique_ptr<
       evaluator<equation<std::decay_t<Ret>(value_t<Obs>...)>>>;
 
+  template <typename Fn>
+  auto equate_inline(Fn const &fn) const
+      -> std::unique_ptr<evaluator<inline_equation_t<Fn>>>;
+
   template <typename Def, typename... Cols>
   auto evaluate(evaluator<Def> const &calc, Cols const &...cols) -> Def *;
 
+  template <typename Op, typename... Cols>
+  auto operate(Op const &op, Cols const &...cols) -> fused_t<Op, Cols...> *;
+
+protected:
+  template <typename Col> auto add_column(Col *col) -> Col *;
+
+  /**
+   * @brief Record the actions whose values an action takes as inputs.
+   */
+  void add_dependencies(action const *act,
+                        std::vector<action const *> const &deps);
+
+  /**
+   * @brief Record that an action is to be executed for each entry, unless all
+   * it would do is to invalidate its cached value (see `column::epoch`).
+   */
+  template <typename Act> void add_execute(Act *act);
+
+  template <typename Act> static constexpr bool needs_execute();
+
+  template <typename Act> static constexpr bool is_shareable();
+
+  /**
+   * @brief Record how to gather the inputs of a batch definition.
+   */
+  template <typename Def> void add_gather(Def *defn);
+
+  template <typename Def>
+  static void gather_as(action *act, unsigned int slot,
+                        unsigned long long entry);
+
+  /**
+   * @brief Record how to share a fused column with the actions reading it.
+   */
+  template <typename Expr> void add_fusion(fused<Expr> *col);
+
+  template <typename Expr> static void share_as(action *act, bool shared);
+
 protected:
-  template <typename Col> auto add_column(std::unique_ptr<Col> col) -> Col *;
+  // column evaluated from the same arguments and inputs
+  struct evaluated_t {
+    std::shared_ptr<arguments const> args;
+    std::vector<action const *> inputs;
+    column::node *column;
+  };
 
 protected:
-  std::vector<std::unique_ptr<column::node>> m_columns; //!
+  arena m_arena;                         //!
+  scratch m_scratch;                     //!
+  column::epoch m_epoch;                 //!
+  std::vector<column::node *> m_columns; //!
+  std::unordered_map<action const *, std::vector<action const *>>
+      m_dependencies;                                     //!
+  std::unordered_set<action const *> m_executes;          //!
+  std::unordered_map<action const *, execute_t> m_gathers; //!
+  std::unordered_map<action const *, share_t> m_fusions;   //!
+
+  // identical columns are only computed once
+  std::map<std::tuple<void const *, std::string, std::type_index>,
+           column::node *>
+      m_reads; //!
+  std::unordered_map<std::type_index, std::vector<evaluated_t>>
+      m_evaluated; //!
 };
 
 } // namespace column
@@ -60,22 +142,38 @@ auto queryosity::column::computation::read(dataset::reader<DS> &ds,
                                            unsigned int slot,
                                            const std::string &name)
     -> read_column_t<DS, Val> * {
+  using column_type = read_column_t<DS, Val>;
+  if constexpr (!computation::is_shareable<column_type>()) {
+    auto rdr = ds.template read_column<Val>(slot, name);
+    auto col = this->add_column(m_arena.adopt(std::move(rdr)));
+    this->add_dependencies(col, {&ds});
+    return col;
+  }
+  const auto key = std::make_tuple(static_cast<void const *>(&ds), name,
+                                   std::type_index(typeid(column_type)));
+  if (auto it = m_reads.find(key); it != m_reads.end())
+    return static_cast<column_type *>(it->second);
   auto rdr = ds.template read_column<Val>(slot, name);
-  return this->add_column(std::move(rdr));
+  auto col = this->add_column(m_arena.adopt(std::move(rdr)));
+  this->add_dependencies(col, {&ds});
+  m_reads.emplace(key, col);
+  return col;
 }
 
 template <typename Val>
-auto queryosity::column::computation::assign(Val const &val) -> fixed<Val> * {
-  auto cnst = std::make_unique<typename column::fixed<Val>>(val);
-  return this->add_column(std::move(cnst));
+auto queryosity::column::computation::assign(
+    std::shared_ptr<const Val> const &val) -> fixed<Val> * {
+  auto cnst = m_arena.make<typename column::fixed<Val>>(val);
+  return this->add_column(cnst);
 }
 
 template <typename To, typename Col>
 auto queryosity::column::computation::convert(Col const &col)
     -> conversion<To, value_t<Col>> * {
-  auto cnv = std::make_unique<conversion<To, value_t<Col>>>(col);
+  auto cnv = m_arena.make<conversion<To, value_t<Col>>>(col);
   cnv->set_arguments(col);
-  return this->add_column(std::move(cnv));
+  this->add_dependencies(cnv, {&col});
+  return this->add_column(cnv);
 }
 
 template <typename Def, typename... Args>
@@ -92,17 +190,103 @@ auto queryosity::column::computation::equate(std::function<Ret(Obs...)> fn)
       evaluator<equation<std::decay_t<Ret>(value_t<Obs>...)>>>(fn);
 }
 
+template <typename Fn>
+auto queryosity::column::computation::equate_inline(Fn const &fn) const
+    -> std::unique_ptr<evaluator<inline_equation_t<Fn>>> {
+  return std::make_unique<evaluator<inline_equation_t<Fn>>>(fn);
+}
+
 template <typename Def, typename... Cols>
 auto queryosity::column::computation::evaluate(evaluator<Def> const &calc,
                                                Cols const &...cols) -> Def * {
-  auto defn = calc.evaluate(cols...);
-  return this->add_column(std::move(defn));
+  std::shared_ptr<arguments const> args;
+  if constexpr (computation::is_shareable<Def>())
+    args = calc.get_arguments();
+  std::vector<action const *> inputs{&cols...};
+  auto &evaluated = m_evaluated[std::type_index(typeid(Def))];
+  if (args) {
+    for (auto const &prev : evaluated) {
+      if (prev.inputs == inputs && prev.args->is_equal(*args))
+        return static_cast<Def *>(prev.column);
+    }
+  }
+  auto defn = calc.evaluate(m_arena, cols...);
+  this->add_dependencies(defn, {&cols...});
+  auto out = this->add_column(defn);
+  if constexpr (is_batch_definition_v<Def>)
+    this->add_gather(out);
+  if (args)
+    evaluated.push_back({args, std::move(inputs), out});
+  return out;
+}
+
+template <typename Op, typename... Cols>
+auto queryosity::column::computation::operate(Op const &op,
+                                              Cols const &...cols)
+    -> fused_t<Op, Cols...> * {
+  auto fsd = m_arena.make<fused_t<Op, Cols...>>(
+      operation<Op, operand_t<Cols>...>(op, operand_of<Cols>::make(cols)...));
+  this->add_dependencies(fsd, {&cols...});
+  this->add_fusion(fsd);
+  return this->add_column(fsd);
 }
 
 template <typename Col>
-auto queryosity::column::computation::add_column(std::unique_ptr<Col> col)
-    -> Col * {
-  auto out = col.get();
-  m_columns.push_back(std::move(col));
-  return out;
-}
\ No newline at end of file
+auto queryosity::column::computation::add_column(Col *col) -> Col * {
+  col->set_epoch(&m_epoch);
+  this->add_execute(col);
+  m_columns.push_back(col);
+  return col;
+}
+
+inline void queryosity::column::computation::add_dependencies(
+    action const *act, std::vector<action const *> const &deps) {
+  auto &inputs = m_dependencies[act];
+  inputs.insert(inputs.end(), deps.begin(), deps.end());
+}
+
+template <typename Act>
+void queryosity::column::computation::add_execute(Act *act) {
+  if constexpr (computation::needs_execute<Act>())
+    m_executes.insert(act);
+}
+
+template <typename Act>
+constexpr bool queryosity::column::computation::needs_execute() {
+  // the class that (last) declared the execute() of the action
+  using execute_type = decltype(&Act::execute);
+  using signature_type = void(unsigned int, unsigned long long);
+  using value_type = value_t<Act>;
+  return !(std::is_same_v<execute_type, signature_type valued<value_type>::*> ||
+           std::is_same_v<execute_type,
+                          signature_type calculation<value_type>::*> ||
+           std::is_same_v<execute_type, signature_type reader<value_type>::*>);
+}
+
+template <typename Act>
+constexpr bool queryosity::column::computation::is_shareable() {
+  // a varied instance must not also be the nominal one, or vice versa
+  return std::is_same_v<decltype(&Act::vary),
+                        void (action::*)(const std::string &)>;
+}
+
+template <typename Def>
+void queryosity::column::computation::add_gather(Def *defn) {
+  m_gathers[defn] = &computation::gather_as<Def>;
+}
+
+template <typename Def>
+void queryosity::column::computation::gather_as(action *act, unsigned int slot,
+                                                unsigned long long entry) {
+  static_cast<Def *>(act)->gather(slot, entry);
+}
+
+template <typename Expr>
+void queryosity::column::computation::add_fusion(fused<Expr> *col) {
+  m_fusions[col] = &computation::share_as<Expr>;
+}
+
+template <typename Expr>
+void queryosity::column::computation::share_as(action *act, bool shared) {
+  static_cast<fused<Expr> *>(act)->set_shared(shared);
+}
@@ -30,7 +30,7 @@ public:
   virtual ~definition() = default;
 
 public:
-  virtual Out calculate() const final override;
+  virtual Out calculate() const override;
 
   /**
    * @brief Compute the quantity of interest for the entry
@@ -25,14 +25,37 @@ public:
 
   virtual void initialize(unsigned int slot, unsigned long long begin,
                           unsigned long long end) final override;
-  virtual void execute(unsigned int slot,
-                       unsigned long long entry) final override;
   virtual void finalize(unsigned int slot) final override;
 
 protected:
   function_type m_evaluate;
 };
 
+/**
+ * @brief Equation that holds its callable as its concrete type.
+ * @tparam Fn Type of the callable.
+ * @details Unlike the type-erased equation, the callable can be inlined into
+ * the computation of the column value.
+ */
+template <typename Out, typename... Ins, typename Fn>
+class equation<Out(Ins...), Fn> : public definition<Out(Ins...)> {
+
+public:
+  using vartuple_type = typename definition<Out(Ins...)>::vartuple_type;
+  using function_type = Fn;
+
+public:
+  equation(Fn const &fn);
+  virtual ~equation() = default;
+
+public:
+  virtual Out calculate() const final override;
+  virtual Out evaluate(observable<Ins>... args) const final override;
+
+protected:
+  Fn m_evaluate;
+};
+
 } // namespace column
 
 } // namespace queryosity
@@ -54,13 +77,27 @@ void queryosity::column::equation<Out(Ins...)>::initialize(
   calculation<Out>::initialize(slot, begin, end);
 }
 
-template <typename Out, typename... Ins>
-void queryosity::column::equation<Out(Ins...)>::execute(
-    unsigned int slot, unsigned long long entry) {
-  calculation<Out>::execute(slot, entry);
-}
-
 template <typename Out, typename... Ins>
 void queryosity::column::equation<Out(Ins...)>::finalize(unsigned int slot) {
   calculation<Out>::finalize(slot);
-}
\ No newline at end of file
+}
+
+template <typename Out, typename... Ins, typename Fn>
+queryosity::column::equation<Out(Ins...), Fn>::equation(Fn const &fn)
+    : m_evaluate(fn) {}
+
+template <typename Out, typename... Ins, typename Fn>
+Out queryosity::column::equation<Out(Ins...), Fn>::calculate() const {
+  // call the callable directly, rather than through evaluate()
+  return std::apply(
+      [this](const variable<Ins> &...args) {
+        return this->m_evaluate(observable<Ins>(args)...);
+      },
+      this->m_arguments);
+}
+
+template <typename Out, typename... Ins, typename Fn>
+Out queryosity::column::equation<Out(Ins...), Fn>::evaluate(
+    observable<Ins>... args) const {
+  return this->m_evaluate(args...);
+}
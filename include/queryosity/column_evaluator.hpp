@@ -2,14 +2,74 @@
 
 #include <functional>
 #include <memory>
+#include <tuple>
 #include <type_traits>
 
 #include "action.hpp"
+#include "arena.hpp"
 
 namespace queryosity {
 
 namespace column {
 
+/**
+ * @brief Constructor arguments of a column, compared to find identical ones.
+ */
+class arguments {
+
+public:
+  arguments() = default;
+  virtual ~arguments() = default;
+
+  virtual bool is_equal(arguments const &other) const = 0;
+
+  /**
+   * @brief Keep the arguments for comparison.
+   * @return The arguments, or `nullptr` if there are none or they cannot be
+   * compared.
+   * @details Arguments are compared by `operator==`, except for empty types
+   * (e.g. lambdas without captures) which are always equal. References and
+   * pointers cannot be compared: instances given the same one would write to
+   * the state behind it all the same. Neither can no arguments at all tell
+   * apart the state that an instance may build up, so none are kept.
+   */
+  template <typename... Args>
+  static std::shared_ptr<arguments const> make(Args const &...args);
+
+protected:
+  template <typename... Args> class tuple;
+
+  template <typename T, typename = void>
+  struct has_equal_to : std::false_type {};
+  template <typename T>
+  struct has_equal_to<T, std::void_t<decltype(bool(std::declval<T const &>() ==
+                                                  std::declval<T const &>()))>>
+      : std::true_type {};
+
+  template <typename T> struct is_reference_wrapper : std::false_type {};
+  template <typename T>
+  struct is_reference_wrapper<std::reference_wrapper<T>> : std::true_type {};
+
+  template <typename T>
+  static constexpr bool is_comparable_v =
+      !is_reference_wrapper<T>::value && !std::is_pointer_v<T> &&
+      (std::is_empty_v<T> || has_equal_to<T>::value);
+
+  template <typename T> static bool is_equal_value(T const &a, T const &b);
+};
+
+template <typename... Args> class arguments::tuple : public arguments {
+
+public:
+  tuple(Args const &...args);
+  virtual ~tuple() = default;
+
+  virtual bool is_equal(arguments const &other) const override;
+
+protected:
+  std::tuple<Args...> m_args;
+};
+
 template <typename T> class evaluator {
 
 public:
@@ -20,25 +80,74 @@ public:
   virtual ~evaluator() = default;
 
   template <typename... Vals>
-  std::unique_ptr<T> evaluate(view<Vals> const &...cols) const;
+  T *evaluate(arena &mem, view<Vals> const &...cols) const;
+
+  std::shared_ptr<arguments const> const &get_arguments() const;
 
 protected:
-  std::function<std::unique_ptr<T>()> m_make;
+  std::function<T *(arena &)> m_make;
+  std::shared_ptr<arguments const> m_arguments;
 };
 } // namespace column
 
 } // namespace queryosity
 
+template <typename... Args>
+std::shared_ptr<queryosity::column::arguments const>
+queryosity::column::arguments::make(Args const &...args) {
+  if constexpr (sizeof...(Args) > 0 && (is_comparable_v<Args> && ...)) {
+    return std::make_shared<tuple<Args...>>(args...);
+  } else {
+    return nullptr;
+  }
+}
+
+template <typename T>
+bool queryosity::column::arguments::is_equal_value(T const &a, T const &b) {
+  if constexpr (std::is_empty_v<T>)
+    return true;
+  else
+    return bool(a == b);
+}
+
+template <typename... Args>
+queryosity::column::arguments::tuple<Args...>::tuple(Args const &...args)
+    : m_args(args...) {}
+
+template <typename... Args>
+bool queryosity::column::arguments::tuple<Args...>::is_equal(
+    arguments const &other) const {
+  auto that = dynamic_cast<tuple const *>(&other);
+  if (!that)
+    return false;
+  return std::apply(
+      [that](Args const &...args) {
+        return std::apply(
+            [&args...](Args const &...others) {
+              return (arguments::is_equal_value(args, others) && ...);
+            },
+            that->m_args);
+      },
+      m_args);
+}
+
 template <typename T>
 template <typename... Args>
 queryosity::column::evaluator<T>::evaluator(Args const &...args)
-    : m_make([args...]() { return std::make_unique<T>(args...); }) {}
+    : m_make([args...](arena &mem) { return mem.make<T>(args...); }),
+      m_arguments(arguments::make(args...)) {}
 
 template <typename T>
 template <typename... Vals>
-std::unique_ptr<T>
-queryosity::column::evaluator<T>::evaluate(view<Vals> const &...columns) const {
-  auto defn = m_make();
+T *queryosity::column::evaluator<T>::evaluate(
+    arena &mem, view<Vals> const &...columns) const {
+  auto defn = m_make(mem);
   defn->set_arguments(columns...);
   return defn;
-}
\ No newline at end of file
+}
+
+template <typename T>
+std::shared_ptr<queryosity::column::arguments const> const &
+queryosity::column::evaluator<T>::get_arguments() const {
+  return m_arguments;
+}
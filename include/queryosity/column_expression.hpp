@@ -32,6 +32,7 @@ template <typename Expr> struct expression {
 public:
   using function_type = decltype(std::function(std::declval<Expr>()));
   using equation_type = equation_t<Expr>;
+  using inline_equation_type = inline_equation_t<Expr>;
 
 public:
   /**
@@ -46,13 +47,16 @@ public:
 
   auto _equate(dataflow &df) const -> todo<evaluator<equation_type>>;
 
+  auto _equate_inline(dataflow &df) const
+      -> todo<evaluator<inline_equation_type>>;
+
   template <typename Sel> auto _select(dataflow &df) const;
 
   template <typename Sel>
   auto _select(dataflow &df, lazy<selection::node> const &presel) const;
 
 protected:
-  function_type m_expression;
+  Expr m_expression;
 };
 
 } // namespace column
@@ -70,19 +74,25 @@ queryosity::column::expression<Expr>::expression(Expr expr)
 template <typename Expr>
 auto queryosity::column::expression<Expr>::_equate(
     queryosity::dataflow &df) const -> todo<evaluator<equation_type>> {
-  return df._equate(this->m_expression);
+  return df._equate(function_type(this->m_expression));
+}
+
+template <typename Expr>
+auto queryosity::column::expression<Expr>::_equate_inline(
+    queryosity::dataflow &df) const -> todo<evaluator<inline_equation_type>> {
+  return df._equate_inline(this->m_expression);
 }
 
 template <typename Expr>
 template <typename Sel>
 auto queryosity::column::expression<Expr>::_select(
     queryosity::dataflow &df) const {
-  return df._select<Sel>(this->m_expression);
+  return df._select<Sel>(function_type(this->m_expression));
 }
 
 template <typename Expr>
 template <typename Sel>
 auto queryosity::column::expression<Expr>::_select(
     queryosity::dataflow &df, lazy<selection::node> const &presel) const {
-  return df._select<Sel>(presel, this->m_expression);
+  return df._select<Sel>(presel, function_type(this->m_expression));
 }
\ No newline at end of file
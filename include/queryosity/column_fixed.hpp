@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "column.hpp"
 
 namespace queryosity {
@@ -11,34 +13,35 @@ template <typename Val> class column::fixed : public valued<Val> {
 
 public:
   fixed(Val const &val);
-  template <typename... Args> fixed(Args &&...args);
+  /**
+   * @brief Constructor sharing an immutable value, e.g. with other slots.
+   */
+  fixed(std::shared_ptr<const Val> val);
   virtual ~fixed() = default;
 
   const Val &value() const final override;
 
   virtual void initialize(unsigned int slot, unsigned long long begin,
                           unsigned long long end) final override;
-  virtual void execute(unsigned int slot,
-                       unsigned long long entry) final override;
   virtual void finalize(unsigned int slot) final override;
 
 protected:
-  Val m_value;
+  std::shared_ptr<const Val> m_value;
 };
 
 } // namespace queryosity
 
 template <typename Val>
-queryosity::column::fixed<Val>::fixed(Val const &val) : m_value(val) {}
+queryosity::column::fixed<Val>::fixed(Val const &val)
+    : m_value(std::make_shared<const Val>(val)) {}
 
 template <typename Val>
-template <typename... Args>
-queryosity::column::fixed<Val>::fixed(Args &&...args)
-    : m_value(std::forward<Args>(args)...) {}
+queryosity::column::fixed<Val>::fixed(std::shared_ptr<const Val> val)
+    : m_value(std::move(val)) {}
 
 template <typename Val>
 const Val &queryosity::column::fixed<Val>::value() const {
-  return m_value;
+  return *m_value;
 }
 
 template <typename Val>
@@ -48,12 +51,6 @@ void queryosity::column::fixed<Val>::initialize(unsigned int slot,
   valued<Val>::initialize(slot, begin, end);
 }
 
-template <typename Val>
-void queryosity::column::fixed<Val>::execute(unsigned int slot,
-                                             unsigned long long entry) {
-  valued<Val>::execute(slot, entry);
-}
-
 template <typename Val>
 void queryosity::column::fixed<Val>::finalize(unsigned int slot) {
   valued<Val>::finalize(slot);
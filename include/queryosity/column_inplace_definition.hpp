@@ -0,0 +1,56 @@
+#pragma once
+
+#include <tuple>
+
+#include "column_definition.hpp"
+
+namespace queryosity {
+
+/**
+ * @ingroup abc
+ * @brief Column definition that computes its value in-place.
+ * @tparam Out Output data type.
+ * @tparam Ins Input column data type(s).
+ * @details The output of the previous entry is handed back to be overwritten,
+ * such that its storage, e.g. the capacity of a container, is re-used from one
+ * entry to the next.
+ */
+template <typename Out, typename... Ins>
+class column::inplace_definition<Out(Ins...)>
+    : public column::definition<Out(Ins...)> {
+
+public:
+  inplace_definition() = default;
+  virtual ~inplace_definition() = default;
+
+public:
+  virtual void calculate_into(Out &out) const final override;
+  virtual Out evaluate(observable<Ins>... args) const final override;
+
+  /**
+   * @brief Compute the quantity of interest for the entry in-place.
+   * @param[in,out] out Output value, as computed for a previous entry.
+   * @param[in] args Input column observables.
+   */
+  virtual void evaluate_into(Out &out, observable<Ins>... args) const = 0;
+};
+
+} // namespace queryosity
+
+template <typename Out, typename... Ins>
+void queryosity::column::inplace_definition<Out(Ins...)>::calculate_into(
+    Out &out) const {
+  std::apply(
+      [this, &out](const variable<Ins> &...args) {
+        this->evaluate_into(out, args...);
+      },
+      this->m_arguments);
+}
+
+template <typename Out, typename... Ins>
+Out queryosity::column::inplace_definition<Out(Ins...)>::evaluate(
+    observable<Ins>... args) const {
+  Out out{};
+  this->evaluate_into(out, args...);
+  return out;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "column.hpp"
+#include "column_calculation.hpp"
+
+namespace queryosity {
+
+namespace column {
+
+/**
+ * @brief Existing column entering an operation.
+ * @tparam T Column value type.
+ */
+template <typename T> class operand {
+
+public:
+  using value_type = T;
+
+public:
+  operand(valued<T> const &col);
+
+  T const &value() const;
+
+protected:
+  valued<T> const *m_column;
+};
+
+/**
+ * @brief Operator applied to other operations and/or operands.
+ * @tparam Op Operator, invoked with the arguments themselves (not their
+ * values) so that they are only evaluated as needed.
+ * @tparam Args Arguments of the operator.
+ */
+template <typename Op, typename... Args> class operation {
+
+public:
+  using value_type = std::decay_t<decltype(std::declval<Op const &>()(
+      std::declval<Args const &>()...))>;
+
+public:
+  operation(Op const &op, Args const &...args);
+
+  value_type value() const;
+
+protected:
+  Op m_op;
+  std::tuple<Args...> m_args;
+};
+
+/**
+ * @brief Column computing a chain of operations all at once.
+ * @tparam Expr Operation computed for each entry.
+ * @details Applying another operation to this column inlines its operations
+ * into the new one rather than reading its value, such that only the outermost
+ * column of a chain is executed if it alone is used by the dataflow. If its
+ * value is read by others as well, it is computed once and read by all of
+ * them instead (see `set_shared()`).
+ */
+template <typename Expr>
+class fused : public calculation<typename Expr::value_type> {
+
+public:
+  fused(Expr const &expr);
+  virtual ~fused() = default;
+
+  virtual typename Expr::value_type calculate() const final override;
+
+  Expr const &get_expression() const;
+
+  /**
+   * @brief Set whether more than one action reads the value of this column.
+   */
+  void set_shared(bool shared);
+  bool is_shared() const;
+
+protected:
+  Expr m_expr;
+  bool m_shared;
+};
+
+/**
+ * @brief Fused column entering an operation.
+ * @tparam Expr Operation of the column.
+ * @details Its operations are computed in place, unless the column is shared
+ * with others, in which case its (cached) value is read.
+ */
+template <typename Expr> class inlined {
+
+public:
+  using value_type = typename Expr::value_type;
+
+public:
+  inlined(fused<Expr> const &col);
+
+  value_type value() const;
+
+protected:
+  fused<Expr> const *m_column;
+  Expr m_expr;
+};
+
+// an operation is inlined, any other column is taken as an operand
+template <typename Col> struct operand_of {
+  using type = operand<value_t<Col>>;
+  static type make(Col const &col) { return type(col); }
+};
+
+template <typename Expr> struct operand_of<fused<Expr>> {
+  using type = inlined<Expr>;
+  static type make(fused<Expr> const &col) { return type(col); }
+};
+
+template <typename Col> using operand_t = typename operand_of<Col>::type;
+
+template <typename Op, typename... Cols>
+using fused_t = fused<operation<Op, operand_t<Cols>...>>;
+
+} // namespace column
+
+} // namespace queryosity
+
+template <typename T>
+queryosity::column::operand<T>::operand(valued<T> const &col)
+    : m_column(&col) {}
+
+template <typename T> T const &queryosity::column::operand<T>::value() const {
+  return m_column->value();
+}
+
+template <typename Op, typename... Args>
+queryosity::column::operation<Op, Args...>::operation(Op const &op,
+                                                      Args const &...args)
+    : m_op(op), m_args(args...) {}
+
+template <typename Op, typename... Args>
+typename queryosity::column::operation<Op, Args...>::value_type
+queryosity::column::operation<Op, Args...>::value() const {
+  return std::apply(m_op, m_args);
+}
+
+template <typename Expr>
+queryosity::column::fused<Expr>::fused(Expr const &expr)
+    : m_expr(expr), m_shared(false) {}
+
+template <typename Expr>
+typename Expr::value_type queryosity::column::fused<Expr>::calculate() const {
+  return m_expr.value();
+}
+
+template <typename Expr>
+Expr const &queryosity::column::fused<Expr>::get_expression() const {
+  return m_expr;
+}
+
+template <typename Expr>
+void queryosity::column::fused<Expr>::set_shared(bool shared) {
+  m_shared = shared;
+}
+
+template <typename Expr>
+bool queryosity::column::fused<Expr>::is_shared() const {
+  return m_shared;
+}
+
+template <typename Expr>
+queryosity::column::inlined<Expr>::inlined(fused<Expr> const &col)
+    : m_column(&col), m_expr(col.get_expression()) {}
+
+template <typename Expr>
+typename queryosity::column::inlined<Expr>::value_type
+queryosity::column::inlined<Expr>::value() const {
+  if (m_column->is_shared())
+    return m_column->value();
+  return m_expr.value();
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cassert>
+
 #include "column.hpp"
 
 namespace queryosity {
@@ -36,11 +38,7 @@ public:
 
 protected:
   mutable T const *m_addr;
-  mutable bool m_updated;
-
-private:
-  unsigned int m_slot;
-  unsigned long long m_entry;
+  mutable unsigned long long m_updated;
 };
 
 } // namespace column
@@ -51,20 +49,18 @@ private:
 
 template <typename T>
 queryosity::column::reader<T>::reader()
-    : m_addr(nullptr), m_updated(false), m_slot(0), m_entry(0) {}
+    : m_addr(nullptr), m_updated(0) {}
 
 template <typename T> T const &queryosity::column::reader<T>::value() const {
-  if (!this->m_updated) {
-    m_addr = &(this->read(this->m_slot, this->m_entry));
-    m_updated = true;
+  // the entry to be read is only known from the epoch of the slot
+  assert(this->m_epoch);
+  if (m_updated != this->m_epoch->count) {
+    m_addr = &(this->read(this->m_epoch->slot, this->m_epoch->entry));
+    m_updated = this->m_epoch->count;
   }
   return *m_addr;
 }
 
 template <typename T>
-void queryosity::column::reader<T>::execute(unsigned int slot,
-                                            unsigned long long entry) {
-  this->m_slot = slot;
-  this->m_entry = entry;
-  this->m_updated = false;
+void queryosity::column::reader<T>::execute(unsigned int, unsigned long long) {
 }
\ No newline at end of file
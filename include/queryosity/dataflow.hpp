@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <future>
 #include <memory>
 #include <set>
 #include <string>
@@ -46,7 +48,7 @@ public:
    * @brief Default constructor.
    */
   dataflow();
-  ~dataflow() = default;
+  ~dataflow();
 
   template <typename Kwd> dataflow(Kwd &&kwarg);
   template <typename Kwd1, typename Kwd2>
@@ -60,6 +62,9 @@ public:
    *  - `queryosity::multithread::disable()`
    *  - `queryosity::dataset::head(unsigned int)`
    *  - `queryosity::dataset::weight(float)`
+   *  - `queryosity::dataset::chunk(unsigned int)`
+   *  - `queryosity::dataset::batch(unsigned int)`
+   *  - `queryosity::dataset::reorder(unsigned int)`
    *
    */
   template <typename Kwd1, typename Kwd2, typename Kwd3>
@@ -125,7 +130,7 @@ public:
    */
   template <typename Fn>
   auto define(column::expression<Fn> const &expr)
-      -> todo<column::evaluator<column::equation_t<Fn>>>;
+      -> todo<column::evaluator<column::inline_equation_t<Fn>>>;
 
   /**
    * @brief Define a column using an expression.
@@ -260,6 +265,15 @@ public:
   //  */
   template <typename... Sels> auto get(selection::yield<Sels...> const &sels);
 
+  /**
+   * @brief Get the yields of many selections as one query.
+   * @tparam Sels Lazy selection(s).
+   * @param[in] sels Selection(s) as report constructor argument(s).
+   * @return Lazy query of the yield at each selection.
+   */
+  template <typename... Sels>
+  auto get(selection::report<Sels...> const &sels);
+
   /**
    * @brief Vary a column constant.
    * @tparam Val Constant value type.
@@ -309,6 +323,41 @@ public:
             std::map<std::string, column::variation<column::value_t<Col>>> const
                 &vars) -> varied<lazy<column::valued<column::value_t<Col>>>>;
 
+  /**
+   * @brief Analyze the dataset(s) for the queries booked so far in the
+   * background.
+   * @return Handle to the analysis.
+   * @details The analysis is run by the worker threads of the dataflow (or a
+   * single one, if multithreading is disabled). Results of the queries wait
+   * for the analysis to finish. Any further operation on the dataflow (e.g.
+   * booking more queries) also waits for it, as the actions are in use until
+   * then, and re-throws the exception of the analysis (if any) unless it has
+   * already been. The dataflow must not be moved while the analysis is in
+   * progress.
+   */
+  std::shared_future<void> analyze_async();
+
+  /**
+   * @brief Get the progress of the analysis in progress (or the last one).
+   * @return Fraction of the entries processed so far.
+   * @details Entries are counted as each thread slot finishes a part of the
+   * dataset. It does not wait for the analysis to finish.
+   */
+  double get_progress() const;
+
+  /**
+   * @brief Get the time each thread slot spent idle in the last analysis.
+   * @return Idle time of each slot, in seconds.
+   */
+  std::vector<std::chrono::duration<double>> const &get_idle_times() const;
+
+  /**
+   * @brief Get the chained cuts reordered by each thread slot in the last
+   * analysis (see `dataset::reorder`).
+   * @return Reordered cuts of each slot.
+   */
+  std::vector<std::vector<selection::reordering>> get_reorderings() const;
+
   /* "public" API for Python layer */
 
   template <typename To, typename Col>
@@ -318,6 +367,10 @@ public:
   template <typename Val>
   auto _assign(Val const &val) -> lazy<column::valued<Val>>;
 
+  template <typename Op, typename... Cols>
+  auto _operate(Op const &op, lazy<Cols> const &...cols)
+      -> lazy<column::fused_t<Op, Cols...>>;
+
   template <typename Def>
   auto _define(column::definition<Def> const &defn)
       -> todo<column::evaluator<Def>>;
@@ -327,6 +380,11 @@ public:
   auto _equate(column::expression<Fn> const &expr)
       -> todo<column::evaluator<column::equation_t<Fn>>>;
 
+  template <typename Fn> auto _equate_inline(Fn const &fn);
+  template <typename Fn>
+  auto _equate_inline(column::expression<Fn> const &expr)
+      -> todo<column::evaluator<column::inline_equation_t<Fn>>>;
+
   template <typename Sel, typename Fn> auto _select(Fn fn);
   template <typename Sel, typename Fn>
   auto _select(lazy<selection::node> const &prev, Fn fn);
@@ -359,6 +417,7 @@ protected:
   template <typename Kwd> void accept_kwarg(Kwd &&kwarg);
 
   void analyze();
+  void analyze(query::node const &qry);
   void reset();
 
 public:
@@ -385,6 +444,10 @@ public:
   auto _book(todo<query::booker<Qry>> const &bkr, lazy<Sels> const &...sels)
       -> std::array<lazy<Qry>, sizeof...(Sels)>;
 
+  template <typename Qry>
+  auto _book(todo<query::booker<Qry>> const &bkr,
+             std::vector<lazy<selection::node>> const &sels) -> lazy<Qry>;
+
   template <typename Syst, typename Val>
   void _vary(Syst &syst, const std::string &name,
              column::constant<Val> const &cnst);
@@ -401,10 +464,15 @@ protected:
   dataset::processor m_processor; //!
   dataset::weight m_weight;       //!
   long long m_nrows;
+  unsigned long long m_nchunk;
+  unsigned long long m_nbatch;
+  unsigned long long m_nsample;
 
   std::vector<std::unique_ptr<dataset::source>> m_sources; //!
 
   mutable bool m_analyzed;
+  std::shared_future<void> m_analysis;
+  bool m_reported;
 };
 
 class dataflow::node {
@@ -455,7 +523,13 @@ protected:
 
 inline queryosity::dataflow::dataflow()
     : m_processor(multithread::disable()), m_weight(1.0), m_nrows(-1),
-      m_analyzed(false) {}
+      m_nchunk(0), m_nbatch(0), m_nsample(0), m_analyzed(false),
+      m_analysis(), m_reported(false) {}
+
+inline queryosity::dataflow::~dataflow() {
+  // sources must outlive an analysis in progress
+  m_processor.wait();
+}
 
 template <typename Kwd>
 queryosity::dataflow::dataflow(Kwd &&kwarg) : dataflow() {
@@ -488,14 +562,24 @@ template <typename Kwd> void queryosity::dataflow::accept_kwarg(Kwd &&kwarg) {
   constexpr bool is_mt_v = std::is_same_v<Kwd, dataset::processor>;
   constexpr bool is_weight_v = std::is_same_v<Kwd, dataset::weight>;
   constexpr bool is_nrows_v = std::is_same_v<Kwd, dataset::head>;
+  constexpr bool is_nchunk_v = std::is_same_v<Kwd, dataset::chunk>;
+  constexpr bool is_nbatch_v = std::is_same_v<Kwd, dataset::batch>;
+  constexpr bool is_nsample_v = std::is_same_v<Kwd, dataset::reorder>;
   if constexpr (is_mt_v) {
     m_processor = std::forward<Kwd>(kwarg);
   } else if constexpr (is_weight_v) {
     m_weight = std::forward<Kwd>(kwarg);
   } else if constexpr (is_nrows_v) {
     m_nrows = std::forward<Kwd>(kwarg);
+  } else if constexpr (is_nchunk_v) {
+    m_nchunk = std::forward<Kwd>(kwarg);
+  } else if constexpr (is_nbatch_v) {
+    m_nbatch = std::forward<Kwd>(kwarg);
+  } else if constexpr (is_nsample_v) {
+    m_nsample = std::forward<Kwd>(kwarg);
   } else {
-    static_assert(is_mt_v || is_weight_v || is_nrows_v,
+    static_assert(is_mt_v || is_weight_v || is_nrows_v || is_nchunk_v ||
+                      is_nbatch_v || is_nsample_v,
                   "unrecognized keyword argument");
   }
 }
@@ -506,6 +590,7 @@ auto queryosity::dataflow::load(queryosity::dataset::input<DS> &&in)
 
   auto ds = in.ds.get();
 
+  m_processor.wait();
   m_sources.emplace_back(std::move(in.ds));
   m_sources.back()->parallelize(m_processor.concurrency());
 
@@ -535,8 +620,8 @@ auto queryosity::dataflow::define(column::constant<Val> const &cnst)
 
 template <typename Fn>
 auto queryosity::dataflow::define(column::expression<Fn> const &expr)
-    -> todo<column::evaluator<column::equation_t<Fn>>> {
-  return this->_equate(expr);
+    -> todo<column::evaluator<column::inline_equation_t<Fn>>> {
+  return this->_equate_inline(expr);
 }
 
 template <typename Def>
@@ -615,12 +700,13 @@ auto queryosity::dataflow::weight(column::definition<Def> const &defn)
 
 template <typename Qry, typename... Args>
 auto queryosity::dataflow::_make(Args &&...args) -> todo<query::booker<Qry>> {
-  return todo<query::booker<Qry>>(*this, ensemble::invoke(
-                                             [&args...](dataset::player *plyr) {
-                                               return plyr->make<Qry>(
-                                                   std::forward<Args>(args)...);
-                                             },
-                                             m_processor.get_slots()));
+  // arguments are copied for each slot, which may be made concurrently
+  return todo<query::booker<Qry>>(
+      *this, m_processor.invoke(
+                 [&args...](dataset::player *plyr) {
+                   return plyr->make<Qry>(static_cast<Args const &>(args)...);
+                 },
+                 m_processor.get_slots()));
 }
 
 template <typename Qry>
@@ -639,11 +725,16 @@ auto queryosity::dataflow::get(selection::yield<Sels...> const &sels) {
   return sels.make(*this);
 }
 
+template <typename... Sels>
+auto queryosity::dataflow::get(selection::report<Sels...> const &sels) {
+  return sels.make(*this);
+}
+
 template <typename Def, typename... Cols>
 auto queryosity::dataflow::_evaluate(todo<column::evaluator<Def>> const &calc,
                                      lazy<Cols> const &...columns)
     -> lazy<Def> {
-  auto act = ensemble::invoke(
+  auto act = m_processor.invoke(
       [](dataset::player *plyr, column::evaluator<Def> const *calc,
          Cols const *...cols) { return plyr->evaluate(*calc, *cols...); },
       m_processor.get_slots(), calc.get_slots(), columns.get_slots()...);
@@ -654,7 +745,7 @@ template <typename Sel, typename Def, typename... Cols>
 auto queryosity::dataflow::_apply(
     todo<selection::applicator<Sel, Def>> const &appl,
     lazy<Cols> const &...columns) -> lazy<selection::node> {
-  auto act = ensemble::invoke(
+  auto act = m_processor.invoke(
       [](dataset::player *plyr, selection::applicator<Sel, Def> const *appl,
          Cols const *...cols) { return plyr->apply(*appl, *cols...); },
       m_processor.get_slots(), appl.get_slots(), columns.get_slots()...);
@@ -668,7 +759,7 @@ auto queryosity::dataflow::_book(todo<query::booker<Qry>> const &bkr,
     -> lazy<Qry> {
   // new query booked: dataset will need to be analyzed
   this->reset();
-  auto act = ensemble::invoke(
+  auto act = m_processor.invoke(
       [](dataset::player *plyr, query::booker<Qry> *bkr,
          selection::node const *sel) { return plyr->book(*bkr, *sel); },
       m_processor.get_slots(), bkr.get_slots(), sel.get_slots());
@@ -683,15 +774,98 @@ auto queryosity::dataflow::_book(todo<query::booker<Qry>> const &bkr,
   return std::array<lazy<Qry>, sizeof...(Sels)>{this->_book(bkr, sels)...};
 }
 
+template <typename Qry>
+auto queryosity::dataflow::_book(
+    todo<query::booker<Qry>> const &bkr,
+    std::vector<lazy<selection::node>> const &sels) -> lazy<Qry> {
+  this->reset();
+  // selections of each slot
+  std::vector<std::vector<selection::node const *>> slot_sels(
+      m_processor.size());
+  for (auto const &sel : sels) {
+    for (unsigned int islot = 0; islot < slot_sels.size(); ++islot) {
+      slot_sels[islot].push_back(sel.get_slot(islot));
+    }
+  }
+  auto act = m_processor.invoke(
+      [](dataset::player *plyr, query::booker<Qry> *bkr,
+         std::vector<selection::node const *> const &sels) {
+        return plyr->book(*bkr, sels);
+      },
+      m_processor.get_slots(), bkr.get_slots(), slot_sels);
+  auto lzy = lazy<Qry>(*this, act);
+  return lzy;
+}
+
 inline void queryosity::dataflow::analyze() {
-  if (m_analyzed)
+  if (m_analyzed) {
+    // wait for the analysis in the background (if any)
+    if (m_analysis.valid()) {
+      try {
+        m_analysis.get();
+      } catch (...) {
+        m_reported = true;
+        throw;
+      }
+    }
     return;
+  }
   m_analyzed = true;
 
-  m_processor.process(m_sources, m_weight, m_nrows);
+  m_processor.process(m_sources, m_weight, m_nrows, m_nbatch, m_nchunk,
+                      m_nsample);
+}
+
+inline void queryosity::dataflow::analyze(query::node const &qry) {
+  // queries from a previous run already have their results: only run the
+  // dataset again for ones booked since
+  m_processor.wait();
+  // but the failure of one in the background is re-thrown all the same
+  if (m_analyzed || !qry.is_analyzed())
+    this->analyze();
+}
+
+inline std::shared_future<void> queryosity::dataflow::analyze_async() {
+  if (!m_analyzed) {
+    m_analyzed = true;
+    m_analysis = m_processor.process_async(m_sources, m_weight, m_nrows,
+                                           m_nbatch, m_nchunk, m_nsample);
+  } else if (!m_analysis.valid()) {
+    // already analyzed in the foreground
+    std::promise<void> done;
+    done.set_value();
+    m_analysis = done.get_future().share();
+  }
+  return m_analysis;
+}
+
+inline void queryosity::dataflow::reset() {
+  m_processor.wait();
+  auto analysis = std::move(m_analysis);
+  const bool reported = m_reported;
+  m_analyzed = false;
+  m_analysis = std::shared_future<void>();
+  m_reported = false;
+  // a failure in the background is not dropped without being reported
+  if (analysis.valid() && !reported)
+    analysis.get();
 }
 
-inline void queryosity::dataflow::reset() { m_analyzed = false; }
+inline double queryosity::dataflow::get_progress() const {
+  return m_processor.get_progress();
+}
+
+inline std::vector<std::chrono::duration<double>> const &
+queryosity::dataflow::get_idle_times() const {
+  m_processor.wait();
+  return m_processor.get_idle_times();
+}
+
+inline std::vector<std::vector<queryosity::selection::reordering>>
+queryosity::dataflow::get_reorderings() const {
+  m_processor.wait();
+  return m_processor.get_reorderings();
+}
 
 template <typename Val>
 auto queryosity::dataflow::vary(column::constant<Val> const &cnst,
@@ -760,8 +934,10 @@ auto queryosity::dataflow::_read(dataset::reader<DS> &ds,
 template <typename Val>
 auto queryosity::dataflow::_assign(Val const &val)
     -> lazy<column::valued<Val>> {
-  auto act = ensemble::invoke(
-      [&val](dataset::player *plyr) { return plyr->assign<Val>(val); },
+  // one immutable value shared by all slots
+  auto const shared = std::make_shared<const Val>(val);
+  auto act = m_processor.invoke(
+      [&shared](dataset::player *plyr) { return plyr->assign<Val>(shared); },
       m_processor.get_slots());
   auto lzy = lazy<column::valued<Val>>(*this, act);
   return lzy;
@@ -770,19 +946,31 @@ auto queryosity::dataflow::_assign(Val const &val)
 template <typename To, typename Col>
 auto queryosity::dataflow::_convert(lazy<Col> const &col)
     -> lazy<column::conversion<To, column::value_t<Col>>> {
-  auto act =
-      ensemble::invoke([](dataset::player *plyr,
-                          Col const *from) { return plyr->convert<To>(*from); },
-                       m_processor.get_slots(), col.get_slots());
+  auto act = m_processor.invoke(
+      [](dataset::player *plyr, Col const *from) {
+        return plyr->convert<To>(*from);
+      },
+      m_processor.get_slots(), col.get_slots());
   auto lzy = lazy<column::conversion<To, column::value_t<Col>>>(*this, act);
   return lzy;
 }
 
+template <typename Op, typename... Cols>
+auto queryosity::dataflow::_operate(Op const &op, lazy<Cols> const &...cols)
+    -> lazy<column::fused_t<Op, Cols...>> {
+  auto act = m_processor.invoke(
+      [&op](dataset::player *plyr, Cols const *...cols) {
+        return plyr->operate(op, *cols...);
+      },
+      m_processor.get_slots(), cols.get_slots()...);
+  return lazy<column::fused_t<Op, Cols...>>(*this, act);
+}
+
 template <typename Def>
 auto queryosity::dataflow::_define(column::definition<Def> const &defn)
     -> todo<column::evaluator<Def>> {
   return todo<column::evaluator<Def>>(
-      *this, ensemble::invoke(
+      *this, m_processor.invoke(
                  [&defn](dataset::player *plyr) { return defn._define(*plyr); },
                  m_processor.get_slots()));
 }
@@ -790,13 +978,22 @@ auto queryosity::dataflow::_define(column::definition<Def> const &defn)
 template <typename Fn> auto queryosity::dataflow::_equate(Fn fn) {
   return todo<column::evaluator<typename column::equation_t<Fn>>>(
       *this,
-      ensemble::invoke([fn](dataset::player *plyr) { return plyr->equate(fn); },
-                       m_processor.get_slots()));
+      m_processor.invoke(
+          [fn](dataset::player *plyr) { return plyr->equate(fn); },
+          m_processor.get_slots()));
+}
+
+template <typename Fn> auto queryosity::dataflow::_equate_inline(Fn const &fn) {
+  return todo<column::evaluator<column::inline_equation_t<Fn>>>(
+      *this,
+      m_processor.invoke(
+          [&fn](dataset::player *plyr) { return plyr->equate_inline(fn); },
+          m_processor.get_slots()));
 }
 
 template <typename Sel, typename Fn> auto queryosity::dataflow::_select(Fn fn) {
   return todo<selection::applicator<Sel, typename column::equation_t<Fn>>>(
-      *this, ensemble::invoke(
+      *this, m_processor.invoke(
                  [fn](dataset::player *plyr) {
                    return plyr->select<Sel>(nullptr, fn);
                  },
@@ -809,10 +1006,16 @@ auto queryosity::dataflow::_equate(column::expression<Fn> const &expr)
   return expr._equate(*this);
 }
 
+template <typename Fn>
+auto queryosity::dataflow::_equate_inline(column::expression<Fn> const &expr)
+    -> todo<column::evaluator<column::inline_equation_t<Fn>>> {
+  return expr._equate_inline(*this);
+}
+
 template <typename Sel, typename Fn>
 auto queryosity::dataflow::_select(lazy<selection::node> const &prev, Fn fn) {
   return todo<selection::applicator<Sel, typename column::equation_t<Fn>>>(
-      *this, ensemble::invoke(
+      *this, m_processor.invoke(
                  [fn](dataset::player *plyr, selection::node const *prev) {
                    return plyr->select<Sel>(prev, fn);
                  },
@@ -836,7 +1039,7 @@ template <typename Sel, typename Def>
 auto queryosity::dataflow::_select(column::definition<Def> const &defn)
     -> todo<selection::applicator<Sel, Def>> {
   return todo<selection::applicator<Sel, Def>>(
-      *this, ensemble::invoke(
+      *this, m_processor.invoke(
                  [&defn](dataset::player *plyr) {
                    return defn.template _select<Sel>(*plyr);
                  },
@@ -848,7 +1051,7 @@ auto queryosity::dataflow::_select(lazy<selection::node> const &prev,
                                    column::definition<Def> const &defn)
     -> todo<selection::applicator<Sel, Def>> {
   return todo<selection::applicator<Sel, Def>>(
-      *this, ensemble::invoke(
+      *this, m_processor.invoke(
                  [&defn](dataset::player *plyr, selection::node const *prev) {
                    return defn.template _select<Sel>(*plyr, *prev);
                  },
@@ -858,10 +1061,11 @@ auto queryosity::dataflow::_select(lazy<selection::node> const &prev,
 template <typename Sel, typename Col>
 auto queryosity::dataflow::_apply(lazy<Col> const &dec)
     -> lazy<selection::node> {
-  auto act =
-      ensemble::invoke([](dataset::player *plyr,
-                          Col *col) { return plyr->apply<Sel>(nullptr, *col); },
-                       m_processor.get_slots(), dec.get_slots());
+  auto act = m_processor.invoke(
+      [](dataset::player *plyr, Col *col) {
+        return plyr->apply<Sel>(nullptr, *col);
+      },
+      m_processor.get_slots(), dec.get_slots());
   auto lzy = lazy<selection::node>(*this, act);
   return lzy;
 }
@@ -870,7 +1074,7 @@ template <typename Sel, typename Col>
 auto queryosity::dataflow::_apply(lazy<selection::node> const &prev,
                                   lazy<Col> const &dec)
     -> lazy<selection::node> {
-  auto act = ensemble::invoke(
+  auto act = m_processor.invoke(
       [](dataset::player *plyr, selection::node const *prev, Col *col) {
         return plyr->apply<Sel>(prev, *col);
       },
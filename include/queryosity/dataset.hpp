@@ -50,6 +50,28 @@ struct weight {
   operator double() { return value; }
 };
 
+struct chunk {
+  chunk(unsigned long long nentries) : nentries(nentries) {}
+  unsigned long long nentries;
+  operator unsigned long long() { return nentries; }
+};
+
+struct batch {
+  batch(unsigned long long nentries) : nentries(nentries) {}
+  unsigned long long nentries;
+  operator unsigned long long() { return nentries; }
+};
+
+/**
+ * @brief Reorder chained cuts by their cost and pass rate, as measured over
+ * the first entries processed by each slot.
+ */
+struct reorder {
+  reorder(unsigned long long nsample) : nsample(nsample) {}
+  unsigned long long nsample;
+  operator unsigned long long() { return nsample; }
+};
+
 } // namespace dataset
 
 } // namespace queryosity
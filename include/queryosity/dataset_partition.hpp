@@ -1,11 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <numeric>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -28,6 +30,20 @@ partition_t align(std::vector<partition_t> const &partitions);
 
 partition_t truncate(partition_t const &parts, long long nentries_max);
 
+/**
+ * @brief Re-size the parts of a partition towards a target number of entries.
+ * @param[in] parts Partition.
+ * @param[in] nentries_per_part Target number of entries in each part.
+ * @param[in] whole Partitions of the datasets whose parts must be kept whole.
+ * @details Adjacent parts are merged as long as the merged part does not
+ * exceed the target. Parts larger than the target are split into as few parts
+ * as needed: evenly, or only where none of the parts to be kept whole would be
+ * split.
+ */
+partition_t plan(partition_t const &parts,
+                 unsigned long long nentries_per_part,
+                 std::vector<partition_t> const &whole = {});
+
 } // namespace partition
 
 } // namespace dataset
@@ -91,4 +107,83 @@ queryosity::dataset::partition::truncate(
   }
 
   return parts_truncated;
-}
\ No newline at end of file
+}
+inline queryosity::dataset::partition_t queryosity::dataset::partition::plan(
+    queryosity::dataset::partition_t const &parts,
+    unsigned long long nentries_per_part,
+    std::vector<partition_t> const &whole) {
+  if (!nentries_per_part)
+    return parts;
+
+  partition_t parts_planned;
+
+  // entries at which every partition to be kept whole can be split
+  std::map<entry_t, unsigned int> edge_counts;
+  for (auto const &unsplittable : whole) {
+    std::set<entry_t> edges;
+    for (auto const &part : unsplittable) {
+      edges.insert(part.first);
+      edges.insert(part.second);
+    }
+    for (auto const &edge : edges) {
+      edge_counts[edge]++;
+    }
+  }
+  std::vector<entry_t> split_edges;
+  for (auto const &edge_count : edge_counts) {
+    if (edge_count.second == whole.size())
+      split_edges.push_back(edge_count.first);
+  }
+
+  // part being merged into
+  auto merged = part_t(0, 0);
+  auto flush = [&]() {
+    if (merged.second > merged.first)
+      parts_planned.push_back(merged);
+    merged = part_t(0, 0);
+  };
+
+  for (auto const &part : parts) {
+    const auto nentries = part.second - part.first;
+    if (nentries > nentries_per_part) {
+      flush();
+      if (!whole.empty()) {
+        // split at the last edge before exceeding the target
+        auto first = part.first;
+        auto last = part.first;
+        auto edge = std::upper_bound(split_edges.begin(), split_edges.end(),
+                                     part.first);
+        for (; edge != split_edges.end() && *edge < part.second; ++edge) {
+          if (*edge - first > nentries_per_part && last > first) {
+            parts_planned.emplace_back(first, last);
+            first = last;
+          }
+          last = *edge;
+        }
+        if (part.second - first > nentries_per_part && last > first) {
+          parts_planned.emplace_back(first, last);
+          first = last;
+        }
+        parts_planned.emplace_back(first, part.second);
+        continue;
+      }
+      // split evenly
+      const auto nsplits =
+          (nentries + nentries_per_part - 1) / nentries_per_part;
+      for (unsigned long long isplit = 0; isplit < nsplits; ++isplit) {
+        parts_planned.emplace_back(part.first + nentries * isplit / nsplits,
+                                   part.first +
+                                       nentries * (isplit + 1) / nsplits);
+      }
+    } else if (merged.second == part.first &&
+               part.second - merged.first <= nentries_per_part) {
+      merged.second = part.second;
+    } else {
+      flush();
+      merged = part;
+    }
+  }
+  flush();
+
+  return parts_planned;
+}
@@ -1,5 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "column_computation.hpp"
 #include "query_experiment.hpp"
 
@@ -7,6 +19,8 @@ namespace queryosity {
 
 namespace dataset {
 
+class scheduler;
+
 class player : public query::experiment {
 
 public:
@@ -15,7 +29,98 @@ public:
 
 public:
   void play(std::vector<std::unique_ptr<source>> const &sources, double scale,
-            slot_t slot, std::vector<part_t> const &parts);
+            slot_t slot, scheduler &parts, unsigned long long nbatch = 0,
+            unsigned long long nsample = 0);
+
+  /**
+   * @brief Chained cuts that were reordered in the last run (if any).
+   */
+  std::vector<selection::reordering> const &get_reorderings() const;
+
+protected:
+  void prune();
+  void branch(bool batched);
+  void chain();
+  void sample();
+  void reorder();
+  bool decide(unsigned long long begin, unsigned long long end);
+  void count(size_t inblock = 0);
+  void advance(unsigned long long entry);
+
+  static unsigned int popcount(std::uint64_t word);
+  static unsigned int lowest_bit(std::uint64_t word);
+
+  void execute(std::vector<std::unique_ptr<source>> const &sources,
+               slot_t slot, part_t const &part);
+  void execute(std::vector<std::unique_ptr<source>> const &sources,
+               slot_t slot, part_t const &part, unsigned long long nbatch);
+
+protected:
+  // batched actions executed one after another, with the inputs of those
+  // that gather them entry-by-entry beforehand (in a single pass)
+  struct stage_t {
+    std::vector<action *> acts;
+    std::vector<std::pair<action *, execute_t>> gathers;
+    std::vector<source *> sources;
+    std::vector<action *> upstream;
+  };
+
+  // selection with the queries booked at it, in depth-first order
+  struct branch_t {
+    selection::node const *selection;
+    std::vector<query::node *> queries;
+    // queries booked at several selections, with the index of this one
+    std::vector<std::pair<query::node *, size_t>> reports;
+    // index past the last selection downstream of this one
+    size_t end;
+    // in blocks, selections whose cuts (and those of their preselections)
+    // are all batched are decided for the whole block at once, from the
+    // outputs of their decision columns (none for weights)
+    bool decided;
+    queryosity::column::block_decisions const *decisions;
+    size_t parent;
+    bool weighted;
+    // entries of the block passing the selection, one bit each
+    std::vector<std::uint64_t> mask;
+    // queries that only need the number of entries passing (unweighted)
+    std::vector<query::node *> tallies;
+    // at the head of reordered cuts, their decisions in the order evaluated
+    // and the last one (where the walk continues if they all pass)
+    std::vector<selection::node const *> reordered;
+    size_t tail;
+  };
+
+  // cuts down a branch with nothing booked in between, such that they can be
+  // evaluated in any order
+  struct chain_t {
+    size_t head;
+    size_t tail;
+    std::vector<selection::node const *> cuts;
+    std::vector<size_t> positions;
+    std::vector<double> costs;
+    std::vector<unsigned long long> npassed;
+    // entries that reached the chain, i.e. passed the preselection of its head
+    unsigned long long nsampled;
+  };
+
+protected:
+  std::unordered_set<action const *> upstream(action const *act) const;
+  void classify(branch_t &branch, branch_t const *prev) const;
+
+protected:
+  std::vector<queryosity::column::node *> m_active_columns;
+  std::vector<selection::node *> m_active_selections;
+  // columns and selections to be executed for each entry (beyond advancing
+  // the epoch)
+  std::vector<action *> m_plan;
+  std::vector<branch_t> m_branches;
+  double m_scale = 1.0;
+  std::vector<chain_t> m_chains;
+  unsigned long long m_nsample = 0;
+  unsigned long long m_nsampled = 0;
+  std::vector<selection::reordering> m_reorderings;
+  // entries of the block passing any of the first selections
+  std::vector<std::uint64_t> m_passed;
 };
 
 } // namespace dataset
@@ -23,54 +128,63 @@ public:
 } // namespace queryosity
 
 #include "dataset_reader.hpp"
+#include "dataset_scheduler.hpp"
 
 inline void queryosity::dataset::player::play(
     std::vector<std::unique_ptr<source>> const &sources, double scale,
-    slot_t slot, std::vector<part_t> const &parts) {
+    slot_t slot, scheduler &parts, unsigned long long nbatch,
+    unsigned long long nsample) {
+
+  m_epoch.slot = slot;
+  m_epoch.scratch = &m_scratch;
 
   // apply dataset scale in effect for all queries
+  m_scale = scale;
   for (auto const &qry : m_queries) {
     qry->apply_scale(scale);
   }
 
-  // traverse each part
-  for (auto const &part : parts) {
+  // only columns & selections needed by the queries are processed
+  this->prune();
+  // queries are counted by walking down the selections
+  this->branch(nbatch > 0);
+  // chained cuts are measured over the first entries to reorder them
+  m_reorderings.clear();
+  m_chains.clear();
+  if (nsample)
+    this->chain();
+  m_nsample = m_chains.empty() ? 0 : nsample;
+  m_nsampled = 0;
+
+  // traverse each part handed out to this slot
+  part_t part;
+  while (parts.next(slot, part)) {
     // initialize
     for (auto const &ds : sources) {
       ds->initialize(slot, part.first, part.second);
     }
-    for (auto const &col : m_columns) {
+    for (auto const &col : m_active_columns) {
       col->initialize(slot, part.first, part.second);
     }
-    for (auto const &sel : m_selections) {
+    for (auto const &sel : m_active_selections) {
       sel->initialize(slot, part.first, part.second);
     }
     for (auto const &qry : m_queries) {
       qry->initialize(slot, part.first, part.second);
     }
     // execute
-    for (auto entry = part.first; entry < part.second; ++entry) {
-      for (auto const &ds : sources) {
-        ds->execute(slot, entry);
-      }
-      for (auto const &col : m_columns) {
-        col->execute(slot, entry);
-      }
-      for (auto const &sel : m_selections) {
-        sel->execute(slot, entry);
-      }
-      for (auto const &qry : m_queries) {
-        qry->execute(slot, entry);
-      }
-    }
+    if (nbatch)
+      this->execute(sources, slot, part, nbatch);
+    else
+      this->execute(sources, slot, part);
     // finalize (in reverse order)
     for (auto const &qry : m_queries) {
       qry->finalize(slot);
     }
-    for (auto const &sel : m_selections) {
+    for (auto const &sel : m_active_selections) {
       sel->finalize(slot);
     }
-    for (auto const &col : m_columns) {
+    for (auto const &col : m_active_columns) {
       col->finalize(slot);
     }
     for (auto const &ds : sources) {
@@ -79,5 +193,536 @@ inline void queryosity::dataset::player::play(
   }
 
   // clear out queries (should not be re-played)
+  for (auto const &qry : m_queries) {
+    qry->set_analyzed();
+  }
   m_queries.clear();
-}
\ No newline at end of file
+}
+
+inline void queryosity::dataset::player::execute(
+    std::vector<std::unique_ptr<source>> const &sources, slot_t slot,
+    part_t const &part) {
+  for (auto entry = part.first; entry < part.second; ++entry) {
+    this->advance(entry);
+    for (auto const &ds : sources) {
+      ds->execute(slot, entry);
+    }
+    for (auto const &step : m_plan) {
+      step->execute(slot, entry);
+    }
+    this->count();
+  }
+}
+
+inline void queryosity::dataset::player::execute(
+    std::vector<std::unique_ptr<source>> const &sources, slot_t slot,
+    part_t const &part, unsigned long long nbatch) {
+  // separate batched actions from the rest, preserving their order
+  std::vector<stage_t> stages;
+  std::vector<source *> unbatched_sources;
+  std::vector<action *> unbatched_plan;
+  std::unordered_set<action const *> staged;
+  std::unordered_set<action const *> needed;
+  auto flush = [&]() {
+    if (stages.empty() || stages.back().gathers.empty() || needed.empty())
+      return;
+    for (auto const &ds : unbatched_sources) {
+      if (needed.count(ds))
+        stages.back().sources.push_back(ds);
+    }
+    for (auto const &step : m_plan) {
+      if (needed.count(step) && !step->is_batched())
+        stages.back().upstream.push_back(step);
+    }
+    needed.clear();
+  };
+  auto push = [&](action *act) {
+    flush();
+    stages.push_back({{act}, {}, {}, {}});
+    staged.clear();
+  };
+  // the entries of a block are not played through ahead of the batched
+  // actions that do not gather their inputs
+  auto check = [&](action const *act) {
+    auto deps = this->upstream(act);
+    for (auto const &ds : unbatched_sources) {
+      if (deps.count(ds))
+        throw std::logic_error(
+            "batched action depends on an unbatched source");
+    }
+  };
+  for (auto const &ds : sources) {
+    if (ds->is_batched())
+      push(ds.get());
+    else
+      unbatched_sources.push_back(ds.get());
+  }
+  for (auto const &col : m_active_columns) {
+    if (!col->is_batched())
+      continue;
+    auto gather = m_gathers.find(col);
+    if (gather == m_gathers.end()) {
+      check(col);
+      push(col);
+      continue;
+    }
+    // batch definitions gather their inputs together, unless one needs
+    // another of the same stage to be executed first
+    auto deps = this->upstream(col);
+    bool joins = !stages.empty() && !stages.back().gathers.empty() &&
+                 std::none_of(deps.begin(), deps.end(), [&](action const *dep) {
+                   return staged.count(dep) > 0;
+                 });
+    if (!joins)
+      push(col);
+    else
+      stages.back().acts.push_back(col);
+    stages.back().gathers.push_back({col, gather->second});
+    staged.insert(col);
+    needed.insert(deps.begin(), deps.end());
+  }
+  for (auto const &step : m_plan) {
+    if (!step->is_batched())
+      unbatched_plan.push_back(step);
+  }
+  for (auto const &qry : m_queries) {
+    if (qry->is_batched()) {
+      check(qry);
+      push(qry);
+    }
+  }
+  flush();
+  // sources are executed for each entry in the passes that read from them,
+  // or at least once per entry if none do
+  std::unordered_set<action const *> gathered;
+  needed.clear();
+  for (auto const &stg : stages) {
+    gathered.insert(stg.sources.begin(), stg.sources.end());
+  }
+  for (auto const &step : unbatched_plan) {
+    auto deps = this->upstream(step);
+    needed.insert(deps.begin(), deps.end());
+  }
+  for (auto const &qry : m_queries) {
+    auto deps = this->upstream(qry);
+    needed.insert(deps.begin(), deps.end());
+  }
+  std::vector<source *> played_sources;
+  for (auto const &ds : unbatched_sources) {
+    if (needed.count(ds) || !gathered.count(ds))
+      played_sources.push_back(ds);
+  }
+  // execute one block at a time
+  for (auto begin = part.first; begin < part.second; begin += nbatch) {
+    const auto end = std::min(begin + nbatch, part.second);
+    for (auto const &stg : stages) {
+      for (auto entry = begin; entry < end && !stg.gathers.empty(); ++entry) {
+        this->advance(entry);
+        for (auto const &ds : stg.sources) {
+          ds->execute(slot, entry);
+        }
+        for (auto const &step : stg.upstream) {
+          step->execute(slot, entry);
+        }
+        for (auto const &gather : stg.gathers) {
+          gather.second(gather.first, slot, entry);
+        }
+      }
+      for (auto const &act : stg.acts) {
+        act->execute_batch(slot, begin, end);
+      }
+    }
+    auto play = [&](unsigned long long entry) {
+      this->advance(entry);
+      for (auto const &ds : played_sources) {
+        ds->execute(slot, entry);
+      }
+      for (auto const &step : unbatched_plan) {
+        step->execute(slot, entry);
+      }
+      this->count(entry - begin);
+    };
+    if (this->decide(begin, end)) {
+      // only the entries passing one of the first selections
+      for (size_t iword = 0; iword < m_passed.size(); ++iword) {
+        for (auto word = m_passed[iword]; word; word &= word - 1) {
+          play(begin + iword * 64 + player::lowest_bit(word));
+        }
+      }
+    } else {
+      for (auto entry = begin; entry < end; ++entry) {
+        play(entry);
+      }
+    }
+    // entries counted all at once
+    for (auto const &branch : m_branches) {
+      if (branch.tallies.empty())
+        continue;
+      unsigned long long npassed = 0;
+      for (auto const &word : branch.mask) {
+        npassed += player::popcount(word);
+      }
+      for (auto const &qry : branch.tallies) {
+        qry->count_many(m_scale, npassed);
+      }
+    }
+  }
+}
+
+inline unsigned int
+queryosity::dataset::player::popcount(std::uint64_t word) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(word);
+#else
+  word = word - ((word >> 1) & 0x5555555555555555ULL);
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return static_cast<unsigned int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+inline unsigned int
+queryosity::dataset::player::lowest_bit(std::uint64_t word) {
+  // bits below the lowest one that is set
+  return player::popcount((word & (~word + 1)) - 1);
+}
+
+inline void queryosity::dataset::player::advance(unsigned long long entry) {
+  // invalidates the values of all columns at once
+  m_epoch.entry = entry;
+  ++m_epoch.count;
+  // temporaries of the previous entry are no longer needed
+  m_scratch.reset();
+}
+
+inline void queryosity::dataset::player::prune() {
+  // find all actions that the queries (indirectly) depend on
+  std::unordered_set<action const *> needed;
+  std::vector<action const *> pending(m_queries.begin(), m_queries.end());
+  while (!pending.empty()) {
+    auto act = pending.back();
+    pending.pop_back();
+    if (!act || !needed.insert(act).second)
+      continue;
+    auto deps = m_dependencies.find(act);
+    if (deps != m_dependencies.end())
+      pending.insert(pending.end(), deps->second.begin(), deps->second.end());
+  }
+  // keep them in their original order
+  m_active_columns.clear();
+  for (auto const &col : m_columns) {
+    if (needed.count(col))
+      m_active_columns.push_back(col);
+  }
+  m_active_selections.clear();
+  for (auto const &sel : m_selections) {
+    if (needed.count(sel))
+      m_active_selections.push_back(sel);
+  }
+  // fused columns read by more than one action are computed once for all of
+  // them, rather than inlined into each
+  std::unordered_map<action const *, unsigned int> nconsumers;
+  for (auto const &act : needed) {
+    auto deps = m_dependencies.find(act);
+    if (deps == m_dependencies.end())
+      continue;
+    for (auto const &dep : deps->second) {
+      ++nconsumers[dep];
+    }
+  }
+  for (auto const &col : m_active_columns) {
+    auto fusion = m_fusions.find(col);
+    if (fusion != m_fusions.end())
+      fusion->second(col, nconsumers[col] > 1);
+  }
+  // lay out what to execute for each entry in one array
+  m_plan.clear();
+  m_plan.reserve(m_active_columns.size() + m_active_selections.size());
+  for (auto const &col : m_active_columns) {
+    if (m_executes.count(col))
+      m_plan.push_back(col);
+  }
+  for (auto const &sel : m_active_selections) {
+    if (m_executes.count(sel))
+      m_plan.push_back(sel);
+  }
+}
+
+inline std::unordered_set<queryosity::action const *>
+queryosity::dataset::player::upstream(action const *act) const {
+  // inputs of the action, up to the batched ones executed for the block
+  std::unordered_set<action const *> needed;
+  std::vector<action const *> pending;
+  auto deps = m_dependencies.find(act);
+  if (deps != m_dependencies.end())
+    pending.assign(deps->second.begin(), deps->second.end());
+  while (!pending.empty()) {
+    auto dep = pending.back();
+    pending.pop_back();
+    if (!dep || !needed.insert(dep).second || dep->is_batched())
+      continue;
+    deps = m_dependencies.find(dep);
+    if (deps != m_dependencies.end())
+      pending.insert(pending.end(), deps->second.begin(), deps->second.end());
+  }
+  return needed;
+}
+
+inline void queryosity::dataset::player::branch(bool batched) {
+  // selections leading up to the queries
+  std::unordered_map<selection::node const *, std::vector<query::node *>>
+      booked;
+  std::unordered_map<selection::node const *,
+                     std::vector<std::pair<query::node *, size_t>>>
+      reported;
+  std::unordered_set<selection::node const *> needed;
+  for (auto const &qry : m_queries) {
+    if (batched && qry->is_batched())
+      continue;
+    auto const &sels = qry->get_selections();
+    if (sels.size() > 1) {
+      for (size_t isel = 0; isel < sels.size(); ++isel) {
+        reported[sels[isel]].push_back({qry, isel});
+      }
+    } else {
+      booked[qry->get_selection()].push_back(qry);
+    }
+    for (auto const &booked_sel : sels) {
+      for (auto sel = booked_sel; sel && needed.insert(sel).second;
+           sel = sel->get_previous())
+        ;
+    }
+  }
+  // selections are always created after their preselection
+  std::unordered_map<selection::node const *,
+                     std::vector<selection::node const *>>
+      children;
+  std::vector<selection::node const *> roots;
+  for (auto const &sel : m_selections) {
+    if (!needed.count(sel))
+      continue;
+    (sel->is_initial() ? roots : children[sel->get_previous()]).push_back(sel);
+  }
+  // lay out depth-first
+  m_branches.clear();
+  std::function<void(selection::node const *, size_t)> descend =
+      [&](selection::node const *sel, size_t parent) {
+        auto ibranch = m_branches.size();
+        m_branches.push_back({sel, booked[sel], reported[sel], 0, false,
+                              nullptr, parent, false, {}, {}, {}, 0});
+        if (batched)
+          this->classify(m_branches.back(),
+                         sel->is_initial() ? nullptr : &m_branches[parent]);
+        for (auto const &child : children[sel]) {
+          descend(child, ibranch);
+        }
+        m_branches[ibranch].end = m_branches.size();
+      };
+  for (auto const &root : roots) {
+    descend(root, 0);
+  }
+}
+
+inline void
+queryosity::dataset::player::classify(branch_t &branch,
+                                      branch_t const *prev) const {
+  auto const sel = branch.selection;
+  // a weight passes whatever its preselection does, while a cut can only be
+  // decided ahead of the entries if its decision column is batched
+  using decisions_t = queryosity::column::block_decisions;
+  const bool is_weight = dynamic_cast<selection::weight const *>(sel);
+  auto deps = m_dependencies.find(sel);
+  if (!is_weight && deps != m_dependencies.end() && !deps->second.empty() &&
+      deps->second.back() && deps->second.back()->is_batched())
+    branch.decisions = dynamic_cast<decisions_t const *>(deps->second.back());
+  branch.decided = (is_weight || branch.decisions) && (!prev || prev->decided);
+  branch.weighted = is_weight || (prev && prev->weighted);
+  if (!branch.decided || branch.weighted)
+    return;
+  // without weights, some queries only need to know how many entries passed
+  std::vector<query::node *> entrywise;
+  for (auto const &qry : branch.queries) {
+    (qry->is_entrywise() ? entrywise : branch.tallies).push_back(qry);
+  }
+  branch.queries = std::move(entrywise);
+}
+
+inline bool queryosity::dataset::player::decide(unsigned long long begin,
+                                                unsigned long long end) {
+  const auto nentries = end - begin;
+  const auto nwords = (nentries + 63) / 64;
+  bool roots = true;
+  m_passed.assign(nwords, 0);
+  for (auto &branch : m_branches) {
+    if (!branch.decided) {
+      roots = roots && !branch.selection->is_initial();
+      continue;
+    }
+    branch.mask.assign(nwords, 0);
+    if (branch.decisions) {
+      // straight from the outputs of the block
+      branch.decisions->decide(begin, end, branch.mask.data());
+    } else {
+      // weights pass every entry
+      std::fill(branch.mask.begin(), branch.mask.end(), ~std::uint64_t(0));
+      if (nentries % 64)
+        branch.mask.back() = (std::uint64_t(1) << (nentries % 64)) - 1;
+    }
+    if (branch.selection->is_initial()) {
+      for (size_t iword = 0; iword < nwords; ++iword) {
+        m_passed[iword] |= branch.mask[iword];
+      }
+    } else {
+      // combined with that of its preselection (laid out before it)
+      auto const &prev = m_branches[branch.parent].mask;
+      for (size_t iword = 0; iword < nwords; ++iword) {
+        branch.mask[iword] &= prev[iword];
+      }
+    }
+  }
+  // whether only the entries passing one of them need to be counted
+  return roots;
+}
+
+inline void queryosity::dataset::player::chain() {
+  // positions of the nominal selections in the order they were applied
+  std::unordered_map<selection::node const *, size_t> positions;
+  for (auto const &sel : m_selections) {
+    if (!sel->is_varied())
+      positions.emplace(sel, positions.size());
+  }
+  // cuts (not weights) that are not decided for blocks of entries
+  auto is_cut = [this](size_t ibranch) {
+    auto const &branch = m_branches[ibranch];
+    return !branch.decided &&
+           dynamic_cast<selection::cut const *>(branch.selection);
+  };
+  // ... with nothing booked at it, and only one selection downstream
+  auto is_link = [this, &is_cut](size_t ibranch) {
+    auto const &branch = m_branches[ibranch];
+    return is_cut(ibranch) && branch.queries.empty() &&
+           branch.reports.empty() && ibranch + 1 < branch.end &&
+           m_branches[ibranch + 1].end == branch.end;
+  };
+  for (size_t ihead = 0; ihead < m_branches.size(); ++ihead) {
+    auto itail = ihead;
+    while (is_link(itail) && is_cut(itail + 1)) {
+      ++itail;
+    }
+    if (itail == ihead)
+      continue;
+    chain_t chain{ihead, itail, {}, {}, {}, {}, 0};
+    for (auto ibranch = ihead; ibranch <= itail; ++ibranch) {
+      auto const &cut = m_branches[ibranch].selection;
+      chain.cuts.push_back(cut);
+      if (positions.count(cut))
+        chain.positions.push_back(positions[cut]);
+    }
+    chain.costs.assign(chain.cuts.size(), 0.0);
+    chain.npassed.assign(chain.cuts.size(), 0);
+    m_chains.push_back(std::move(chain));
+    ihead = itail;
+  }
+}
+
+inline void queryosity::dataset::player::sample() {
+  using clock_type = std::chrono::steady_clock;
+  // every decision is evaluated, regardless of the others, for the entries
+  // that reach the chain
+  for (auto &chain : m_chains) {
+    auto presel = m_branches[chain.head].selection->get_previous();
+    if (presel && !presel->passed_cut())
+      continue;
+    ++chain.nsampled;
+    for (size_t icut = 0; icut < chain.cuts.size(); ++icut) {
+      const auto start = clock_type::now();
+      const bool passed = chain.cuts[icut]->passed_decision();
+      const std::chrono::duration<double> cost = clock_type::now() - start;
+      chain.costs[icut] += cost.count();
+      chain.npassed[icut] += passed;
+    }
+  }
+  if (++m_nsampled == m_nsample)
+    this->reorder();
+}
+
+inline void queryosity::dataset::player::reorder() {
+  for (auto const &chain : m_chains) {
+    // kept as they are if no entry reached them
+    if (!chain.nsampled)
+      continue;
+    const auto nsampled = static_cast<double>(chain.nsampled);
+    // the expected cost per entry is minimized by evaluating first the cuts
+    // most likely to fail for the time they take
+    auto rank = [&chain, nsampled](size_t icut) {
+      const auto rate = chain.npassed[icut] / nsampled;
+      return rate < 1.0 ? chain.costs[icut] / (1.0 - rate)
+                        : std::numeric_limits<double>::infinity();
+    };
+    std::vector<size_t> order(chain.cuts.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&rank](size_t a, size_t b) { return rank(a) < rank(b); });
+    auto &head = m_branches[chain.head];
+    head.reordered.clear();
+    head.tail = chain.tail;
+    for (auto const &icut : order) {
+      head.reordered.push_back(chain.cuts[icut]);
+    }
+    // only (entirely) nominal chains are reported
+    if (chain.positions.size() < chain.cuts.size())
+      continue;
+    selection::reordering reordered;
+    for (auto const &icut : order) {
+      reordered.order.push_back(chain.positions[icut]);
+      reordered.costs.push_back(chain.costs[icut] / nsampled);
+      reordered.rates.push_back(chain.npassed[icut] / nsampled);
+    }
+    m_reorderings.push_back(std::move(reordered));
+  }
+  m_nsample = 0;
+}
+
+inline std::vector<queryosity::selection::reordering> const &
+queryosity::dataset::player::get_reorderings() const {
+  return m_reorderings;
+}
+
+inline void queryosity::dataset::player::count(size_t inblock) {
+  if (m_nsampled < m_nsample)
+    this->sample();
+  for (size_t ibranch = 0; ibranch < m_branches.size();) {
+    auto const &branch = m_branches[ibranch];
+    if (!branch.reordered.empty()) {
+      // the cuts down to the last one pass or fail together
+      bool passed = true;
+      for (auto const &cut : branch.reordered) {
+        if (!cut->passed_decision()) {
+          passed = false;
+          break;
+        }
+      }
+      ibranch = passed ? branch.tail : branch.end;
+      continue;
+    }
+    const bool passed =
+        branch.decided ? (branch.mask[inblock / 64] >> (inblock % 64)) & 1
+                       : branch.selection->passed_cut();
+    // skip everything downstream of a failed cut
+    if (!passed) {
+      ibranch = branch.end;
+      continue;
+    }
+    if (!branch.queries.empty() || !branch.reports.empty()) {
+      // scaled once for all queries at the selection
+      const auto weight = m_scale * branch.selection->get_weight();
+      for (auto const &qry : branch.queries) {
+        qry->count(weight);
+      }
+      for (auto const &[qry, isel] : branch.reports) {
+        qry->count_at(isel, weight);
+      }
+    }
+    ++ibranch;
+  }
+}
@@ -2,9 +2,12 @@
 
 #include "dataset.hpp"
 #include "dataset_player.hpp"
+#include "dataset_scheduler.hpp"
 #include "multithread.hpp"
 
 #include <atomic>
+#include <chrono>
+#include <future>
 
 namespace queryosity {
 
@@ -12,7 +15,8 @@ namespace dataset {
 
 class processor : public multithread::core, public ensemble::slotted<player> {
 public:
-  processor(int suggestion);
+  processor(int suggestion,
+            multithread::affinity pin = multithread::affinity::none);
   virtual ~processor() = default;
 
   processor(const processor &) = delete;
@@ -27,21 +31,72 @@ public:
 
   void downsize(unsigned int nslots);
   void process(std::vector<std::unique_ptr<source>> const &sources,
-               double scale, unsigned long long nrows);
+               double scale, unsigned long long nrows,
+               unsigned long long nbatch = 0, unsigned long long nchunk = 0,
+               unsigned long long nsample = 0);
+
+  /**
+   * @brief Process the dataset(s) in the background.
+   * @return Handle to the processing, which re-throws any exception on
+   * `get()`.
+   * @details The slots must not be accessed until the processing finishes:
+   * `invoke()` and `read()` wait for it to.
+   */
+  std::shared_future<void>
+  process_async(std::vector<std::unique_ptr<source>> const &sources,
+                double scale, unsigned long long nrows,
+                unsigned long long nbatch = 0, unsigned long long nchunk = 0,
+                unsigned long long nsample = 0);
+
+  /**
+   * @brief Wait for the background processing (if any) to finish.
+   */
+  void wait() const;
+
+  template <typename Fn, typename... Args>
+  auto invoke(Fn const &fn, std::vector<Args> const &...args) const;
 
   virtual std::vector<player *> const &get_slots() const override;
 
+  /**
+   * @brief Time spent by each slot waiting for others to finish in the last
+   * event loop.
+   */
+  std::vector<std::chrono::duration<double>> const &get_idle_times() const;
+
+  /**
+   * @brief Fraction of the entries processed by the current (or last) event
+   * loop, which may be polled while it runs in the background.
+   */
+  double get_progress() const;
+
+  /**
+   * @brief Chained cuts reordered by each slot in the last event loop.
+   */
+  std::vector<std::vector<selection::reordering>> get_reorderings() const;
+
+protected:
+  std::shared_ptr<scheduler>
+  schedule(std::vector<std::unique_ptr<source>> const &sources,
+           unsigned long long nrows, unsigned long long nchunk);
+  void conclude(std::vector<std::unique_ptr<source>> const &sources,
+                scheduler const &parts);
+
 protected:
   std::vector<unsigned int> m_range_slots;
   std::vector<dataset::player> m_players; //!
   std::vector<dataset::player *> m_player_ptrs;
+  std::vector<std::chrono::duration<double>> m_idle_times;
+  std::shared_ptr<scheduler> m_parts;
+  std::shared_future<void> m_processing;
 };
 
 } // namespace dataset
 
 namespace multithread {
 
-dataset::processor enable(int suggestion = -1);
+dataset::processor enable(int suggestion = -1,
+                          affinity pin = affinity::none);
 dataset::processor disable();
 
 } // namespace multithread
@@ -49,17 +104,18 @@ dataset::processor disable();
 } // namespace queryosity
 
 inline queryosity::dataset::processor
-queryosity::multithread::enable(int suggestion) {
-  return dataset::processor(suggestion);
+queryosity::multithread::enable(int suggestion, affinity pin) {
+  return dataset::processor(suggestion, pin);
 }
 
 inline queryosity::dataset::processor queryosity::multithread::disable() {
   return dataset::processor(false);
 }
 
-inline queryosity::dataset::processor::processor(int suggestion)
-    : multithread::core::core(suggestion), m_range_slots(), m_players(),
-      m_player_ptrs() {
+inline queryosity::dataset::processor::processor(int suggestion,
+                                                 multithread::affinity pin)
+    : multithread::core::core(suggestion, pin), m_range_slots(), m_players(),
+      m_player_ptrs(), m_idle_times(), m_parts(), m_processing() {
   const auto nslots = this->concurrency();
   m_players = std::vector<player>(nslots);
   m_player_ptrs = std::vector<player *>(nslots, nullptr);
@@ -76,6 +132,7 @@ template <typename DS, typename Val>
 auto queryosity::dataset::processor::read(dataset::reader<DS> &ds,
                                           const std::string &column_name)
     -> std::vector<read_column_t<DS, Val> *> {
+  this->wait();
   return ensemble::invoke(
       [column_name, &ds](dataset::player *plyr, unsigned int slot) {
         return plyr->template read<DS, Val>(ds, slot, column_name);
@@ -97,7 +154,29 @@ inline void queryosity::dataset::processor::downsize(unsigned int nslots) {
 
 inline void queryosity::dataset::processor::process(
     std::vector<std::unique_ptr<source>> const &sources, double scale,
-    unsigned long long nrows) {
+    unsigned long long nrows, unsigned long long nbatch,
+    unsigned long long nchunk, unsigned long long nsample) {
+  this->wait();
+
+  // 1-2. enter event loop & partition dataset(s)
+  auto parts = this->schedule(sources, nrows, nchunk);
+
+  // 3. run event loop
+  this->run(
+      [&sources, scale, &parts, nbatch, nsample](dataset::player *plyr,
+                                                 unsigned int slot) {
+        plyr->play(sources, scale, slot, *parts, nbatch, nsample);
+      },
+      m_player_ptrs, m_range_slots);
+
+  // 4. exit event loop
+  this->conclude(sources, *parts);
+}
+
+inline std::shared_ptr<queryosity::dataset::scheduler>
+queryosity::dataset::processor::schedule(
+    std::vector<std::unique_ptr<source>> const &sources,
+    unsigned long long nrows, unsigned long long nchunk) {
 
   const auto nslots = this->concurrency();
 
@@ -109,10 +188,14 @@ inline void queryosity::dataset::processor::process(
   // 2. partition dataset(s)
   // 2.1 get partition from each dataset source
   std::vector<partition_t> partitions_from_sources;
+  std::vector<partition_t> partitions_whole;
   for (auto const &ds : sources) {
     auto partition_from_source = ds->partition();
-    if (partition_from_source.size())
+    if (partition_from_source.size()) {
+      if (!ds->is_splittable())
+        partitions_whole.push_back(partition_from_source);
       partitions_from_sources.push_back(std::move(partition_from_source));
+    }
   }
   if (!partitions_from_sources.size()) {
     throw std::runtime_error("no valid dataset partition found");
@@ -123,29 +206,18 @@ inline void queryosity::dataset::processor::process(
   // 2.3 truncate entries to row limit
   const auto partition_truncated =
       dataset::partition::truncate(partition_aligned, nrows);
-  // 2.3 distribute partition amongst threads
-  std::vector<partition_t> partitions_for_slots(nslots);
-  auto nparts_remaining = partition_truncated.size();
-  const auto nparts = nparts_remaining;
-  while (nparts_remaining) {
-    for (unsigned int islot = 0; islot < nslots; ++islot) {
-      partitions_for_slots[islot].push_back(
-          std::move(partition_truncated[nparts - (nparts_remaining--)]));
-      if (!nparts_remaining)
-        break;
-    }
-  }
-
-  // 3. run event loop
-  // TODO: use intel TBB?
-  this->run(
-      [&sources, scale](
-          dataset::player *plyr, unsigned int slot,
-          std::vector<std::pair<unsigned long long, unsigned long long>> const
-              &parts) { plyr->play(sources, scale, slot, parts); },
-      m_player_ptrs, m_range_slots, partitions_for_slots);
+  // 2.4 split/merge parts towards the requested size
+  const auto partition_planned =
+      dataset::partition::plan(partition_truncated, nchunk, partitions_whole);
+  // 2.5 distribute partition amongst threads
+  m_parts = std::make_shared<scheduler>(partition_planned, nslots);
+  return m_parts;
+}
 
-  // 4. exit event loop
+inline void queryosity::dataset::processor::conclude(
+    std::vector<std::unique_ptr<source>> const &sources,
+    scheduler const &parts) {
+  m_idle_times = parts.get_idle_times(scheduler::clock_type::now());
   for (auto const &ds : sources) {
     ds->finalize();
   }
@@ -154,4 +226,60 @@ inline void queryosity::dataset::processor::process(
 inline std::vector<queryosity::dataset::player *> const &
 queryosity::dataset::processor::get_slots() const {
   return m_player_ptrs;
-}
\ No newline at end of file
+}
+
+inline std::vector<std::chrono::duration<double>> const &
+queryosity::dataset::processor::get_idle_times() const {
+  return m_idle_times;
+}
+
+inline double queryosity::dataset::processor::get_progress() const {
+  return m_parts ? m_parts->get_progress() : 0.0;
+}
+
+inline std::vector<std::vector<queryosity::selection::reordering>>
+queryosity::dataset::processor::get_reorderings() const {
+  std::vector<std::vector<selection::reordering>> reorderings;
+  reorderings.reserve(m_player_ptrs.size());
+  for (auto const &plyr : m_player_ptrs) {
+    reorderings.push_back(plyr->get_reorderings());
+  }
+  return reorderings;
+}
+
+inline std::shared_future<void> queryosity::dataset::processor::process_async(
+    std::vector<std::unique_ptr<source>> const &sources, double scale,
+    unsigned long long nrows, unsigned long long nbatch,
+    unsigned long long nchunk, unsigned long long nsample) {
+  this->wait();
+  auto parts = this->schedule(sources, nrows, nchunk);
+  // slots are run by the workers of the pool, even if multithreading is
+  // disabled (by its only worker)
+  const auto nslots = m_player_ptrs.size();
+  this->prepare(nslots);
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(nslots);
+  for (size_t islot = 0; islot < nslots; ++islot) {
+    tasks.emplace_back([this, &sources, scale, parts, nbatch, nsample,
+                        islot]() {
+      m_player_ptrs[islot]->play(sources, scale, m_range_slots[islot], *parts,
+                                 nbatch, nsample);
+    });
+  }
+  m_processing = m_pool->submit(
+      std::move(tasks),
+      [this, &sources, parts]() { this->conclude(sources, *parts); });
+  return m_processing;
+}
+
+inline void queryosity::dataset::processor::wait() const {
+  if (m_processing.valid())
+    m_processing.wait();
+}
+
+template <typename Fn, typename... Args>
+auto queryosity::dataset::processor::invoke(
+    Fn const &fn, std::vector<Args> const &...args) const {
+  this->wait();
+  return multithread::core::invoke(fn, args...);
+}
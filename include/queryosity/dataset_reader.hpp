@@ -49,6 +49,16 @@ public:
   virtual std::vector<std::pair<unsigned long long, unsigned long long>>
   partition() = 0;
 
+  /**
+   * @brief Whether the parts of the partition can be split further.
+   * @return `true` by default.
+   * @details A dataset whose parts are best processed whole (e.g. compressed
+   * clusters of entries) should return `false`, in which case its parts may
+   * still be merged with adjacent ones, but the partition is only split
+   * between them. Other datasets are split as needed regardless.
+   */
+  virtual bool is_splittable() const;
+
   /**
    * @brief Enter an entry loop.
    * @param[in] slot Thread slot number.
@@ -117,6 +127,8 @@ using read_column_t =
 
 inline void queryosity::dataset::source::initialize() {}
 
+inline bool queryosity::dataset::source::is_splittable() const { return true; }
+
 inline void queryosity::dataset::source::initialize(unsigned int,
                                                     unsigned long long,
                                                     unsigned long long) {}
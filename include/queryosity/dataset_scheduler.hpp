@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "dataset.hpp"
+#include "dataset_partition.hpp"
+
+namespace queryosity {
+
+namespace dataset {
+
+/**
+ * @brief Hand out the parts of a dataset partition to slots as they become
+ * free.
+ * @details Each slot is dealt a contiguous share of the parts up front, which
+ * it works through from the front. Once its own share runs out, a slot steals
+ * from the back of the slot with the most parts remaining, down to the last
+ * one: the part its owner is working on has already been taken off the queue.
+ */
+class scheduler {
+
+public:
+  using clock_type = std::chrono::steady_clock;
+
+public:
+  scheduler(partition_t const &parts, unsigned int nslots);
+  ~scheduler() = default;
+
+  scheduler(scheduler const &) = delete;
+  scheduler &operator=(scheduler const &) = delete;
+
+  /**
+   * @brief Take the next part to be processed by a slot.
+   * @param[in] slot Thread slot index.
+   * @param[out] part Part to be processed.
+   * @return `false` if there are no parts left for the slot.
+   */
+  bool next(slot_t slot, part_t &part);
+
+  /**
+   * @brief Time spent by each slot waiting for others to finish.
+   * @param[in] end Time at which the last slot finished.
+   */
+  std::vector<std::chrono::duration<double>>
+  get_idle_times(clock_type::time_point end) const;
+
+  /**
+   * @brief Fraction of the entries processed so far.
+   * @details Entries are counted in parts, as each slot moves on from one to
+   * the next. It may be polled by any thread while the slots are running.
+   */
+  double get_progress() const;
+
+protected:
+  bool steal(slot_t slot, part_t &part);
+
+protected:
+  struct queue {
+    std::mutex mutex;
+    std::deque<part_t> parts;
+  };
+  std::vector<queue> m_queues;
+  std::vector<clock_type::time_point> m_finished;
+  // entries of the part each slot is on
+  std::vector<unsigned long long> m_current;
+  unsigned long long m_nentries;
+  std::atomic<unsigned long long> m_ndone;
+};
+
+} // namespace dataset
+
+} // namespace queryosity
+
+inline queryosity::dataset::scheduler::scheduler(partition_t const &parts,
+                                                 unsigned int nslots)
+    : m_queues(nslots), m_finished(nslots), m_current(nslots, 0),
+      m_nentries(0), m_ndone(0) {
+  for (auto const &part : parts) {
+    m_nentries += part.second - part.first;
+  }
+  const auto nparts = parts.size();
+  for (unsigned int islot = 0; islot < nslots; ++islot) {
+    const auto first = nparts * islot / nslots;
+    const auto last = nparts * (islot + 1) / nslots;
+    m_queues[islot].parts.assign(parts.begin() + first, parts.begin() + last);
+  }
+}
+
+inline bool queryosity::dataset::scheduler::next(slot_t slot, part_t &part) {
+  // the previous part of the slot (if any) is done
+  m_ndone += m_current[slot];
+  m_current[slot] = 0;
+  bool taken = false;
+  {
+    auto &own = m_queues[slot];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.parts.empty()) {
+      part = own.parts.front();
+      own.parts.pop_front();
+      taken = true;
+    }
+  }
+  if (taken || this->steal(slot, part)) {
+    m_current[slot] = part.second - part.first;
+    return true;
+  }
+  m_finished[slot] = clock_type::now();
+  return false;
+}
+
+inline bool queryosity::dataset::scheduler::steal(slot_t slot, part_t &part) {
+  while (true) {
+    // pick the slot with the most parts left to steal from
+    slot_t victim = slot;
+    size_t nmost = 0;
+    for (slot_t islot = 0; islot < m_queues.size(); ++islot) {
+      if (islot == slot)
+        continue;
+      std::lock_guard<std::mutex> lock(m_queues[islot].mutex);
+      if (m_queues[islot].parts.size() > nmost) {
+        victim = islot;
+        nmost = m_queues[islot].parts.size();
+      }
+    }
+    if (victim == slot)
+      return false;
+    auto &other = m_queues[victim];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    // the victim may have moved on in the meantime
+    if (!other.parts.empty()) {
+      part = other.parts.back();
+      other.parts.pop_back();
+      return true;
+    }
+  }
+}
+
+inline std::vector<std::chrono::duration<double>>
+queryosity::dataset::scheduler::get_idle_times(
+    clock_type::time_point end) const {
+  std::vector<std::chrono::duration<double>> idle_times;
+  idle_times.reserve(m_finished.size());
+  for (auto const &finished : m_finished) {
+    idle_times.push_back(end - finished);
+  }
+  return idle_times;
+}
+
+inline double queryosity::dataset::scheduler::get_progress() const {
+  return m_nentries ? double(m_ndone) / double(m_nentries) : 1.0;
+}
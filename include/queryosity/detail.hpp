@@ -44,17 +44,17 @@
                          column::value_t<V>,                                   \
                          column::value_t<typename Arg::action_type>>::value),  \
                 bool>::type = true>                                            \
-  auto operator op_symbol(Arg const &arg)                                      \
-      const->queryosity::lazy<queryosity::column::valued<                      \
-          decltype(std::declval<column::value_t<V>>() op_symbol std::declval<  \
-                   column::value_t<typename Arg::action_type>>())>> {          \
-    return this->m_df                                                          \
-        ->define(queryosity::column::expression(                               \
-            [](queryosity::column::observable<column::value_t<V>> me,          \
-               queryosity::column::observable<                                 \
-                   column::value_t<typename Arg::action_type>>                 \
-                   you) { return me.value() op_symbol you.value(); }))         \
-        .evaluate(*this, arg);                                                 \
+  auto operator op_symbol(Arg const &arg) const {                              \
+    if constexpr (queryosity::is_varied_v<Arg>) {                              \
+      return queryosity::varied<queryosity::lazy<Action>>(*this)               \
+          op_symbol arg;                                                       \
+    } else {                                                                   \
+      return this->m_df->_operate(                                             \
+          [](auto const &me, auto const &you) {                                \
+            return me.value() op_symbol you.value();                           \
+          },                                                                   \
+          *this, arg);                                                         \
+    }                                                                          \
   }
 
 #define CHECK_FOR_UNARY_OP(op_name, op_symbol)                                 \
@@ -76,12 +76,8 @@
                            detail::has_##op_name##_v<column::value_t<V>>,      \
                        bool> = false>                                          \
   auto operator op_symbol() const {                                            \
-    return this->m_df                                                          \
-        ->define(queryosity::column::expression(                               \
-            [](queryosity::column::observable<column::value_t<V>> me) {        \
-              return (op_symbol me.value());                                   \
-            }))                                                                \
-        .evaluate(*this);                                                      \
+    return this->m_df->_operate(                                               \
+        [](auto const &me) { return (op_symbol me.value()); }, *this);         \
   }
 
 #define CHECK_FOR_INDEX_OP()                                                   \
@@ -109,13 +105,15 @@
                                column::value_t<typename Arg::action_type>>,    \
                        bool> = false>                                          \
   auto operator[](Arg const &arg) const {                                      \
-    return this->m_df                                                          \
-        ->define(queryosity::column::expression(                               \
-            [](queryosity::column::observable<column::value_t<V>> me,          \
-               queryosity::column::observable<                                 \
-                   column::value_t<typename Arg::action_type>>                 \
-                   index) { return me.value()[index.value()]; }))              \
-        .evaluate(*this, arg);                                                 \
+    if constexpr (queryosity::is_varied_v<Arg>) {                              \
+      return queryosity::varied<queryosity::lazy<Action>>(*this)[arg];         \
+    } else {                                                                   \
+      return this->m_df->_operate(                                             \
+          [](auto const &me, auto const &index) {                              \
+            return me.value()[index.value()];                                  \
+          },                                                                   \
+          *this, arg);                                                         \
+    }                                                                          \
   }
 
 #define DECLARE_LAZY_VARIED_BINARY_OP(op_symbol)                               \
@@ -494,7 +494,7 @@ template <typename V,
           std::enable_if_t<queryosity::query::has_result_v<V>, bool>>
 auto queryosity::lazy<Action>::result() const
     -> decltype(std::declval<V>().result()) const & {
-  this->m_df->analyze();
+  this->m_df->analyze(*this->get_slot(0));
   this->merge_results();
   return this->m_result;
 }
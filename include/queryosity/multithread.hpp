@@ -3,12 +3,25 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <type_traits>
 #include <vector>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace queryosity {
 
 namespace ensemble {
@@ -44,10 +57,82 @@ auto invoke(Fn const &fn, std::vector<Args> const &...args) -> std::enable_if_t<
 
 namespace multithread {
 
+/**
+ * @brief Where to pin the thread of each slot.
+ * @details Pinning is only supported on Linux, and ignored elsewhere.
+ */
+enum class affinity {
+  none, //!< Let the operating system schedule the threads.
+  core, //!< Pin each slot to its own core (round-robin).
+  node  //!< Pin each slot to the cores of a NUMA node (round-robin).
+};
+
+/**
+ * @brief Long-lived set of worker threads.
+ * @details Workers are parked in between runs, and each run hands worker `i`
+ * the `i`-th task, so that no threads are spawned after construction.
+ */
+class pool {
+
+public:
+  pool(unsigned int nworkers, affinity pin = affinity::none);
+  ~pool();
+
+  pool(const pool &) = delete;
+  pool &operator=(const pool &) = delete;
+
+  /**
+   * @brief Run the tasks on the workers, and wait for all of them to finish.
+   * @param[in] tasks One task per worker (at most).
+   * @details The first exception thrown by a task (if any) is re-thrown.
+   */
+  void run(std::vector<std::function<void()>> const &tasks);
+
+  /**
+   * @brief Start running the tasks on the workers, without waiting for them.
+   * @param[in] tasks One task per worker (at most).
+   * @param[in] done (Optional) called once all tasks have finished, by the
+   * worker that finished last.
+   * @return Handle to the run, which re-throws the first exception thrown by a
+   * task (or by @p done).
+   * @details A run only starts once the previous one has finished.
+   */
+  std::shared_future<void> submit(std::vector<std::function<void()>> tasks,
+                                  std::function<void()> done = nullptr);
+
+  unsigned int size() const { return m_workers.size(); }
+
+protected:
+  void work(unsigned int iworker);
+  void complete(std::unique_lock<std::mutex> &lock);
+
+  static std::vector<std::vector<int>> find_cpus(unsigned int nworkers,
+                                                 affinity pin);
+  static void pin_cpus(std::vector<int> const &cpus);
+
+protected:
+  std::vector<std::vector<int>> m_cpus;
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_started;
+  std::condition_variable m_finished;
+  std::vector<std::function<void()>> m_tasks;
+  std::function<void()> m_done;
+  // number of tasks of the current run (none in between runs)
+  size_t m_ntasks;
+  unsigned long long m_generation;
+  unsigned int m_pending;
+  bool m_running;
+  bool m_stopped;
+  std::exception_ptr m_error;
+  std::promise<void> m_promise;
+};
+
 class core {
 
 public:
-  core(int suggestion);
+  core(int suggestion, affinity pin = affinity::none);
 
   core(const core &) = default;
   core &operator=(const core &) = default;
@@ -65,20 +150,219 @@ public:
   template <typename Fn, typename... Args>
   void run(Fn const &fn, std::vector<Args> const &...args) const;
 
+  /**
+   * @brief Call the function on each slot, and collect the results.
+   * @param[in] fn Function to be called.
+   * @param[in] args Arguments applied per-slot to function.
+   * @details If the slots are pinned, each call is made from the thread that
+   * will process the slot, such that whatever it allocates is local to it.
+   * Otherwise, the calls are made in order from the calling thread.
+   */
+  template <typename Fn, typename... Args>
+  auto invoke(Fn const &fn, std::vector<Args> const &...args) const;
+
   bool is_enabled() const { return m_enabled; }
+  affinity get_affinity() const { return m_affinity; }
   unsigned int concurrency() const { return m_concurrency; }
 
+protected:
+  void prepare(unsigned int nslots) const;
+
 protected:
   bool m_enabled;
   unsigned int m_concurrency;
+  affinity m_affinity;
+  mutable std::shared_ptr<pool> m_pool;
 };
 
 } // namespace multithread
 
 } // namespace queryosity
 
-inline queryosity::multithread::core::core(int suggestion)
-    : m_enabled(suggestion) {
+inline queryosity::multithread::pool::pool(unsigned int nworkers,
+                                           affinity pin)
+    : m_cpus(find_cpus(nworkers, pin)), m_tasks(), m_done(), m_ntasks(0),
+      m_generation(0), m_pending(0), m_running(false), m_stopped(false) {
+  m_workers.reserve(nworkers);
+  for (unsigned int iworker = 0; iworker < nworkers; ++iworker) {
+    m_workers.emplace_back(&pool::work, this, iworker);
+  }
+}
+
+inline queryosity::multithread::pool::~pool() {
+  {
+    // let the run in progress (if any) finish
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this]() { return !m_running; });
+    m_stopped = true;
+  }
+  m_started.notify_all();
+  for (auto &&worker : m_workers) {
+    worker.join();
+  }
+}
+
+inline void queryosity::multithread::pool::run(
+    std::vector<std::function<void()>> const &tasks) {
+  this->submit(tasks).get();
+}
+
+inline std::shared_future<void> queryosity::multithread::pool::submit(
+    std::vector<std::function<void()>> tasks, std::function<void()> done) {
+  assert(tasks.size() <= m_workers.size());
+  std::unique_lock<std::mutex> lock(m_mutex);
+  // one run at a time
+  m_finished.wait(lock, [this]() { return !m_running; });
+  m_running = true;
+  m_tasks = std::move(tasks);
+  m_done = std::move(done);
+  m_ntasks = m_tasks.size();
+  m_pending = m_tasks.size();
+  m_error = nullptr;
+  m_promise = std::promise<void>();
+  auto handle = m_promise.get_future().share();
+  ++m_generation;
+  if (m_pending)
+    m_started.notify_all();
+  else
+    this->complete(lock);
+  return handle;
+}
+
+inline void
+queryosity::multithread::pool::complete(std::unique_lock<std::mutex> &lock) {
+  // no other run can start until this one is complete
+  if (m_done) {
+    lock.unlock();
+    try {
+      m_done();
+    } catch (...) {
+      lock.lock();
+      if (!m_error)
+        m_error = std::current_exception();
+      lock.unlock();
+    }
+    lock.lock();
+  }
+  m_tasks.clear();
+  m_done = nullptr;
+  m_ntasks = 0;
+  if (m_error)
+    m_promise.set_exception(m_error);
+  else
+    m_promise.set_value();
+  m_running = false;
+  m_finished.notify_all();
+}
+
+inline void queryosity::multithread::pool::work(unsigned int iworker) {
+  if (iworker < m_cpus.size())
+    pin_cpus(m_cpus[iworker]);
+  unsigned long long generation = 0;
+  while (true) {
+    std::function<void()> const *task = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_started.wait(lock, [this, generation]() {
+        return m_stopped || m_generation != generation;
+      });
+      if (m_stopped)
+        return;
+      generation = m_generation;
+      // workers without a task may only wake up once the run has finished,
+      // by when the tasks are gone
+      if (iworker < m_ntasks)
+        task = &m_tasks[iworker];
+    }
+    // worker not needed for this run
+    if (!task)
+      continue;
+    std::exception_ptr error;
+    try {
+      (*task)();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (error && !m_error)
+        m_error = error;
+      if (!--m_pending)
+        this->complete(lock);
+    }
+  }
+}
+
+inline std::vector<std::vector<int>>
+queryosity::multithread::pool::find_cpus(unsigned int nworkers, affinity pin) {
+  std::vector<std::vector<int>> cpus;
+#if defined(__linux__)
+  if (pin == affinity::none)
+    return cpus;
+  // cores available to the process
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed))
+    return cpus;
+  // group them into the cores of each NUMA node, or each on its own
+  std::vector<std::vector<int>> groups;
+  if (pin == affinity::node) {
+    for (unsigned int inode = 0;; ++inode) {
+      std::ifstream cpulist("/sys/devices/system/node/node" +
+                            std::to_string(inode) + "/cpulist");
+      if (!cpulist)
+        break;
+      // e.g. "0-3,8-11"
+      std::vector<int> group;
+      std::string range;
+      while (std::getline(cpulist, range, ',')) {
+        int first = 0, last = 0;
+        char dash = 0;
+        std::istringstream in(range);
+        in >> first;
+        last = (in >> dash >> last) ? last : first;
+        for (int cpu = first; cpu <= last; ++cpu) {
+          if (CPU_ISSET(cpu, &allowed))
+            group.push_back(cpu);
+        }
+      }
+      if (!group.empty())
+        groups.push_back(std::move(group));
+    }
+  } else {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &allowed))
+        groups.push_back({cpu});
+    }
+  }
+  if (groups.empty())
+    return cpus;
+  for (unsigned int iworker = 0; iworker < nworkers; ++iworker) {
+    cpus.push_back(groups[iworker % groups.size()]);
+  }
+#else
+  (void)nworkers;
+  (void)pin;
+#endif
+  return cpus;
+}
+
+inline void
+queryosity::multithread::pool::pin_cpus(std::vector<int> const &cpus) {
+#if defined(__linux__)
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (auto cpu : cpus) {
+    CPU_SET(cpu, &mask);
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+#else
+  (void)cpus;
+#endif
+}
+
+inline queryosity::multithread::core::core(int suggestion, affinity pin)
+    : m_enabled(suggestion), m_affinity(pin), m_pool() {
   if (!suggestion) // single-threaded
     m_concurrency = 1;
   else if (suggestion < 0) // maximum thread count
@@ -95,14 +379,13 @@ void queryosity::multithread::core::run(
 
   if (this->is_enabled()) {
     // enabled
-    std::vector<std::thread> pool;
-    pool.reserve(nslots);
+    this->prepare(nslots);
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(nslots);
     for (size_t islot = 0; islot < nslots; ++islot) {
-      pool.emplace_back(fn, args.at(islot)...);
-    }
-    for (auto &&thread : pool) {
-      thread.join();
+      tasks.emplace_back([&fn, &args..., islot]() { fn(args.at(islot)...); });
     }
+    m_pool->run(tasks);
   } else {
     // disabled
     for (size_t islot = 0; islot < nslots; ++islot) {
@@ -111,6 +394,47 @@ void queryosity::multithread::core::run(
   }
 }
 
+template <typename Fn, typename... Args>
+auto queryosity::multithread::core::invoke(
+    Fn const &fn, std::vector<Args> const &...args) const {
+  if (!this->is_enabled() || m_affinity == affinity::none)
+    return ensemble::invoke(fn, args...);
+
+  using result_t = typename std::invoke_result_t<Fn, Args...>;
+  auto nslots = ensemble::check(args...);
+  this->prepare(nslots);
+  if constexpr (std::is_void_v<result_t>) {
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(nslots);
+    for (size_t islot = 0; islot < nslots; ++islot) {
+      tasks.emplace_back([&fn, &args..., islot]() { fn(args.at(islot)...); });
+    }
+    m_pool->run(tasks);
+  } else {
+    std::vector<std::optional<result_t>> results(nslots);
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(nslots);
+    for (size_t islot = 0; islot < nslots; ++islot) {
+      tasks.emplace_back([&fn, &args..., &results, islot]() {
+        results[islot].emplace(fn(args.at(islot)...));
+      });
+    }
+    m_pool->run(tasks);
+    std::vector<result_t> invoked;
+    invoked.reserve(nslots);
+    for (auto &result : results) {
+      invoked.push_back(std::move(*result));
+    }
+    return invoked;
+  }
+}
+
+inline void queryosity::multithread::core::prepare(unsigned int nslots) const {
+  // (re-)use the pool of workers, spawning it only the first time round
+  if (!m_pool || m_pool->size() < nslots)
+    m_pool = std::make_shared<pool>(nslots, m_affinity);
+}
+
 template <typename T, typename... Args>
 inline unsigned int
 queryosity::ensemble::check(std::vector<T> const &first,
@@ -66,6 +66,14 @@ public:
   void set_selection(const selection::node &selection);
   const selection::node *get_selection() const;
 
+  /**
+   * @brief Book the query at several selections at once.
+   * @param[in] selections Selections, in the order they are indexed by
+   * `count_at()`.
+   */
+  void set_selections(std::vector<const selection::node *> const &selections);
+  std::vector<const selection::node *> const &get_selections() const;
+
   virtual void initialize(unsigned int slot, unsigned long long begin,
                           unsigned long long end) override;
   virtual void execute(unsigned int slot,
@@ -74,9 +82,51 @@ public:
 
   virtual void count(double w) = 0;
 
+  /**
+   * @brief Count entries that have all passed the selection with the same
+   * weight.
+   * @param[in] w Weight of each entry.
+   * @param[in] n Number of entries.
+   * @details By default, the entries are counted one at a time.
+   */
+  virtual void count_many(double w, unsigned long long n);
+
+  /**
+   * @brief Whether the query depends on the values of each entry it counts,
+   * i.e. must count them one at a time as they are processed.
+   * @return `true` by default.
+   */
+  virtual bool is_entrywise() const;
+
+  /**
+   * @brief Count an entry that has passed one of the selections of the query.
+   * @param[in] isel Index of the selection (see `set_selections()`).
+   * @param[in] w Weight of the entry at the selection.
+   * @details By default, the entry is counted regardless of the selection.
+   */
+  virtual void count_at(size_t isel, double w);
+
+  /**
+   * @brief Count an entry that has passed the selection of the query.
+   * @param[in] w Weight of the entry at the selection.
+   */
+  void count_passed(double w);
+
+  /**
+   * @brief Mark the query as having been run over the dataset.
+   */
+  void set_analyzed();
+
+  /**
+   * @brief Whether the query has been run over the dataset.
+   */
+  bool is_analyzed() const;
+
 protected:
   double m_scale;
   const selection::node *m_selection;
+  std::vector<const selection::node *> m_selections;
+  bool m_analyzed;
 };
 
 template <typename T>
@@ -124,11 +174,13 @@ protected:
 #include "column.hpp"
 #include "selection.hpp"
 
-inline queryosity::query::node::node() : m_scale(1.0), m_selection(nullptr) {}
+inline queryosity::query::node::node()
+    : m_scale(1.0), m_selection(nullptr), m_analyzed(false) {}
 
 inline void
 queryosity::query::node::set_selection(const selection::node &selection) {
   m_selection = &selection;
+  m_selections = {&selection};
 }
 
 inline const queryosity::selection::node *
@@ -136,6 +188,17 @@ queryosity::query::node::get_selection() const {
   return m_selection;
 }
 
+inline void queryosity::query::node::set_selections(
+    std::vector<const selection::node *> const &selections) {
+  m_selection = selections.empty() ? nullptr : selections.front();
+  m_selections = selections;
+}
+
+inline std::vector<const queryosity::selection::node *> const &
+queryosity::query::node::get_selections() const {
+  return m_selections;
+}
+
 inline void queryosity::query::node::apply_scale(double scale) {
   m_scale *= scale;
 }
@@ -146,8 +209,29 @@ inline void queryosity::query::node::initialize(unsigned int,
 
 inline void queryosity::query::node::execute(unsigned int, unsigned long long) {
   if (m_selection->passed_cut()) {
-    this->count(m_scale * m_selection->get_weight());
+    this->count_passed(m_selection->get_weight());
+  }
+}
+
+inline void queryosity::query::node::count_many(double w,
+                                               unsigned long long n) {
+  for (unsigned long long i = 0; i < n; ++i) {
+    this->count(w);
   }
 }
 
-inline void queryosity::query::node::finalize(unsigned int) {}
\ No newline at end of file
+inline bool queryosity::query::node::is_entrywise() const { return true; }
+
+inline void queryosity::query::node::count_at(size_t, double w) {
+  this->count(w);
+}
+
+inline void queryosity::query::node::count_passed(double w) {
+  this->count(m_scale * w);
+}
+
+inline void queryosity::query::node::finalize(unsigned int) {}
+
+inline void queryosity::query::node::set_analyzed() { m_analyzed = true; }
+
+inline bool queryosity::query::node::is_analyzed() const { return m_analyzed; }
\ No newline at end of file
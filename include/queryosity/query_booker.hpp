@@ -5,6 +5,7 @@
 #include <utility>
 #include <vector>
 
+#include "arena.hpp"
 #include "query.hpp"
 
 namespace queryosity {
@@ -26,16 +27,21 @@ public:
   auto add_columns(column::valued<Vals> const &...cols) const
       -> std::unique_ptr<booker<T>>;
 
-  auto set_selection(const selection::node &sel) const -> std::unique_ptr<T>;
+  auto set_selection(arena &mem, const selection::node &sel) const -> T *;
+  auto set_selections(arena &mem,
+                      std::vector<const selection::node *> const &sels) const
+      -> T *;
+
+  std::vector<column::node const *> const &get_columns() const;
 
 protected:
-  std::unique_ptr<T> make_query();
   template <typename... Vals>
   void fill_query(column::valued<Vals> const &...cols);
 
 protected:
-  std::function<std::unique_ptr<T>()> m_make_unique_query;
+  std::function<T *(arena &)> m_make_query;
   std::vector<std::function<void(T &)>> m_add_columns;
+  std::vector<column::node const *> m_columns;
 };
 
 } // namespace queryosity
@@ -43,9 +49,9 @@ protected:
 template <typename T>
 template <typename... Args>
 queryosity::query::booker<T>::booker(Args... args)
-    : m_make_unique_query(std::bind(
-          [](Args... args) { return std::make_unique<T>(args...); }, args...)) {
-}
+    : m_make_query(std::bind(
+          [](arena &mem, Args... args) { return mem.make<T>(args...); },
+          std::placeholders::_1, args...)) {}
 
 template <typename T>
 template <typename... Vals>
@@ -70,13 +76,14 @@ void queryosity::query::booker<T>::fill_query(
         cnt.enter_columns(cols...);
       },
       std::placeholders::_1, std::cref(columns)...));
+  (m_columns.push_back(&columns), ...);
 }
 
 template <typename T>
 auto queryosity::query::booker<T>::set_selection(
-    const selection::node &sel) const -> std::unique_ptr<T> {
+    arena &mem, const selection::node &sel) const -> T * {
   // call constructor
-  auto cnt = m_make_unique_query();
+  auto cnt = m_make_query(mem);
   // fill columns (if set)
   for (auto const &fill_query : m_add_columns) {
     fill_query(*cnt);
@@ -84,4 +91,22 @@ auto queryosity::query::booker<T>::set_selection(
   // book cnt at the selection
   cnt->set_selection(sel);
   return cnt;
-}
\ No newline at end of file
+}
+
+template <typename T>
+auto queryosity::query::booker<T>::set_selections(
+    arena &mem, std::vector<const selection::node *> const &sels) const -> T * {
+  auto cnt = m_make_query(mem);
+  for (auto const &fill_query : m_add_columns) {
+    fill_query(*cnt);
+  }
+  // book cnt at all of the selections
+  cnt->set_selections(sels);
+  return cnt;
+}
+
+template <typename T>
+std::vector<queryosity::column::node const *> const &
+queryosity::query::booker<T>::get_columns() const {
+  return m_columns;
+}
@@ -23,12 +23,21 @@ public:
   template <typename Qry>
   auto book(query::booker<Qry> const &bkr, const selection::node &sel) -> Qry *;
 
+  /**
+   * @brief Book a query at several selections at once.
+   * @param[in] bkr Query booker.
+   * @param[in] sels Selections, or all existing nominal ones (in the order they
+   * were applied) if empty.
+   */
+  template <typename Qry>
+  auto book(query::booker<Qry> const &bkr,
+            std::vector<const selection::node *> sels) -> Qry *;
+
 protected:
-  template <typename Qry> auto add_query(std::unique_ptr<Qry> qry) -> Qry *;
+  template <typename Qry> auto add_query(Qry *qry) -> Qry *;
 
 protected:
   std::vector<query::node *> m_queries;
-  std::vector<std::unique_ptr<query::node>> m_queries_history; //!
 };
 
 } // namespace queryosity
@@ -43,15 +52,32 @@ queryosity::query::experiment::make(Args &&...args) {
 template <typename Qry>
 auto queryosity::query::experiment::book(query::booker<Qry> const &bkr,
                                          const selection::node &sel) -> Qry * {
-  auto qry = bkr.set_selection(sel);
-  return this->add_query(std::move(qry));
+  auto qry = bkr.set_selection(m_arena, sel);
+  std::vector<action const *> deps{&sel};
+  deps.insert(deps.end(), bkr.get_columns().begin(), bkr.get_columns().end());
+  this->add_dependencies(qry, deps);
+  return this->add_query(qry);
 }
 
 template <typename Qry>
-auto queryosity::query::experiment::add_query(std::unique_ptr<Qry> qry)
+auto queryosity::query::experiment::book(
+    query::booker<Qry> const &bkr, std::vector<const selection::node *> sels)
     -> Qry * {
-  auto out = qry.get();
-  m_queries_history.push_back(std::move(qry));
-  m_queries.push_back(m_queries_history.back().get());
-  return out;
+  if (sels.empty()) {
+    for (auto const &sel : m_selections) {
+      if (!sel->is_varied())
+        sels.push_back(sel);
+    }
+  }
+  auto qry = bkr.set_selections(m_arena, sels);
+  std::vector<action const *> deps(sels.begin(), sels.end());
+  deps.insert(deps.end(), bkr.get_columns().begin(), bkr.get_columns().end());
+  this->add_dependencies(qry, deps);
+  return this->add_query(qry);
+}
+
+template <typename Qry>
+auto queryosity::query::experiment::add_query(Qry *qry) -> Qry * {
+  m_queries.push_back(qry);
+  return qry;
 }
\ No newline at end of file
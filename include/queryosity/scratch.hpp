@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+namespace queryosity {
+
+/**
+ * @brief Memory for the temporaries of a slot, reclaimed all at once.
+ * @details Allocations are bumped one after another into blocks, and freeing
+ * them does nothing. Once reset, the same blocks are reused from the start,
+ * such that no memory is requested from the system in the steady state.
+ */
+class scratch : public std::pmr::memory_resource {
+
+public:
+  scratch(size_t block_size = 64 * 1024);
+  virtual ~scratch();
+
+  scratch(scratch const &) = delete;
+  scratch &operator=(scratch const &) = delete;
+
+  /**
+   * @brief Reclaim all memory allocated so far.
+   */
+  void reset();
+
+protected:
+  virtual void *do_allocate(size_t bytes, size_t alignment) override;
+  virtual void do_deallocate(void *p, size_t bytes,
+                             size_t alignment) override;
+  virtual bool
+  do_is_equal(std::pmr::memory_resource const &other) const noexcept override;
+
+protected:
+  struct block {
+    std::byte *data;
+    size_t size;
+  };
+
+protected:
+  size_t m_block_size;
+  std::vector<block> m_blocks;
+  size_t m_current;
+  size_t m_used;
+};
+
+} // namespace queryosity
+
+inline queryosity::scratch::scratch(size_t block_size)
+    : m_block_size(block_size), m_current(0), m_used(0) {}
+
+inline queryosity::scratch::~scratch() {
+  for (auto const &blk : m_blocks) {
+    ::operator delete(blk.data);
+  }
+}
+
+inline void queryosity::scratch::reset() {
+  m_current = 0;
+  m_used = 0;
+}
+
+inline void *queryosity::scratch::do_allocate(size_t bytes, size_t alignment) {
+  // padding needed to align an address
+  auto padding = [alignment](std::byte const *addr) {
+    const auto ptr = reinterpret_cast<std::uintptr_t>(addr);
+    return static_cast<size_t>((alignment - ptr % alignment) % alignment);
+  };
+  // continue to the next block(s) kept from before, as long as they fit
+  for (; m_current < m_blocks.size(); ++m_current, m_used = 0) {
+    auto const &blk = m_blocks[m_current];
+    const auto offset = m_used + padding(blk.data + m_used);
+    if (offset + bytes <= blk.size) {
+      m_used = offset + bytes;
+      return blk.data + offset;
+    }
+  }
+  // otherwise, allocate a new one large enough
+  const auto size = std::max(bytes + alignment, m_block_size);
+  m_blocks.push_back({static_cast<std::byte *>(::operator new(size)), size});
+  m_current = m_blocks.size() - 1;
+  auto const &blk = m_blocks.back();
+  const auto offset = padding(blk.data);
+  m_used = offset + bytes;
+  return blk.data + offset;
+}
+
+inline void queryosity::scratch::do_deallocate(void *, size_t, size_t) {}
+
+inline bool queryosity::scratch::do_is_equal(
+    std::pmr::memory_resource const &other) const noexcept {
+  return this == &other;
+}
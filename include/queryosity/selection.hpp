@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cassert>
 #include <memory>
 #include <string>
 #include <vector>
@@ -28,6 +29,24 @@ class counter;
 
 template <typename... Ts> struct yield;
 
+class reporter;
+
+template <typename... Ts> struct report;
+
+/**
+ * @brief Chained cuts, in the order that their decisions are evaluated.
+ * @details The cuts are identified by their position among all nominal
+ * selections, in the order they were applied; chains of systematic variations
+ * are reordered all the same, but not reported. Their cost (average time to
+ * evaluate the decision, in seconds) and pass rate are as measured over the
+ * sampled entries that passed the preselection of the first cut.
+ */
+struct reordering {
+  std::vector<size_t> order;
+  std::vector<double> costs;
+  std::vector<double> rates;
+};
+
 class node : public column::calculation<double> {
 
 public:
@@ -38,18 +57,52 @@ public:
   bool is_initial() const noexcept;
   const selection::node *get_previous() const noexcept;
 
-  virtual bool passed_cut() const = 0;
-  virtual double get_weight() const = 0;
-
+  /**
+   * @brief Whether this selection is a systematic variation, rather than a
+   * nominal one.
+   */
+  bool is_varied() const noexcept;
+
+  /**
+   * @brief Whether the entry passes the cuts up to this selection.
+   * @details Computed at most once per entry, such that it is readily
+   * available to everything downstream.
+   */
+  bool passed_cut() const;
+
+  /**
+   * @brief Weight of the entry, from the weights up to this selection.
+   * @details Computed at most once per entry, such that it is readily
+   * available to everything downstream.
+   */
+  double get_weight() const;
+
+  /**
+   * @brief Whether the entry passes the decision of this selection alone,
+   * regardless of its preselection.
+   */
+  virtual bool passed_decision() const = 0;
+
+  virtual void vary(const std::string &variation_name) override;
   virtual void initialize(unsigned int slot, unsigned long long begin,
                           unsigned long long end) final override;
-  virtual void execute(unsigned int slot,
-                       unsigned long long entry) final override;
   virtual void finalize(unsigned int slot) final override;
 
+protected:
+  virtual bool calculate_cut() const = 0;
+  virtual double calculate_weight() const = 0;
+
 protected:
   const selection::node *const m_preselection;
   column::variable<double> m_decision;
+
+  // cut and weight are cached separately, as either may not be needed
+  mutable bool m_passed_cut;
+  mutable double m_weight;
+  mutable unsigned long long m_cut_updated;
+  mutable unsigned long long m_weight_updated;
+
+  bool m_varied;
 };
 
 template <typename T> struct is_applicable : std::false_type {};
@@ -71,7 +124,9 @@ constexpr bool is_selection_v = std::is_base_of_v<selection::node, T>;
 
 inline queryosity::selection::node::node(const selection::node *presel,
                                          column::variable<double> dec)
-    : m_preselection(presel), m_decision(std::move(dec)) {}
+    : m_preselection(presel), m_decision(std::move(dec)), m_passed_cut(false),
+      m_weight(0.0), m_cut_updated(~0ull), m_weight_updated(~0ull),
+      m_varied(false) {}
 
 inline bool queryosity::selection::node::is_initial() const noexcept {
   return m_preselection ? false : true;
@@ -82,17 +137,38 @@ queryosity::selection::node::get_previous() const noexcept {
   return m_preselection;
 }
 
+inline bool queryosity::selection::node::is_varied() const noexcept {
+  return m_varied;
+}
+
+inline void queryosity::selection::node::vary(const std::string &) {
+  m_varied = true;
+}
+
+inline bool queryosity::selection::node::passed_cut() const {
+  assert(this->m_epoch);
+  if (m_cut_updated != this->m_epoch->count) {
+    m_passed_cut = this->calculate_cut();
+    m_cut_updated = this->m_epoch->count;
+  }
+  return m_passed_cut;
+}
+
+inline double queryosity::selection::node::get_weight() const {
+  assert(this->m_epoch);
+  if (m_weight_updated != this->m_epoch->count) {
+    m_weight = this->calculate_weight();
+    m_weight_updated = this->m_epoch->count;
+  }
+  return m_weight;
+}
+
 inline void queryosity::selection::node::initialize(unsigned int slot,
                                                     unsigned long long begin,
                                                     unsigned long long end) {
   column::calculation<double>::initialize(slot, begin, end);
 }
 
-inline void queryosity::selection::node::execute(unsigned int slot,
-                                                 unsigned long long entry) {
-  column::calculation<double>::execute(slot, entry);
-}
-
 inline void queryosity::selection::node::finalize(unsigned int slot) {
   column::calculation<double>::finalize(slot);
 }
\ No newline at end of file
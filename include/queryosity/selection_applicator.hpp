@@ -24,8 +24,10 @@ public:
   virtual ~applicator() = default;
 
   template <typename... Vals>
-  std::pair<std::unique_ptr<Sel>, std::unique_ptr<Def>>
-  apply(column::view<Vals> const &...columns) const;
+  std::pair<Sel *, Def *> apply(arena &mem,
+                                column::view<Vals> const &...columns) const;
+
+  selection::node const *get_previous() const;
 
 protected:
   selection::node const *m_prev;
@@ -46,10 +48,14 @@ queryosity::selection::applicator<Sel, Def>::applicator(
 
 template <typename Sel, typename Def>
 template <typename... Vals>
-std::pair<std::unique_ptr<Sel>, std::unique_ptr<Def>>
-queryosity::selection::applicator<Sel, Def>::apply(
-    column::view<Vals> const &...columns) const {
-  auto col = this->evaluate(columns...);
-  auto sel = std::make_unique<Sel>(m_prev, column::variable<double>(*col));
-  return {std::move(sel), std::move(col)};
-}
\ No newline at end of file
+std::pair<Sel *, Def *> queryosity::selection::applicator<Sel, Def>::apply(
+    arena &mem, column::view<Vals> const &...columns) const {
+  auto col = this->evaluate(mem, columns...);
+  auto sel = mem.make<Sel>(m_prev, column::variable<double>(*col));
+  return {sel, col};
+}
+template <typename Sel, typename Def>
+queryosity::selection::node const *
+queryosity::selection::applicator<Sel, Def>::get_previous() const {
+  return m_prev;
+}
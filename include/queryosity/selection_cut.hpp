@@ -12,8 +12,11 @@ public:
 
 public:
   virtual double calculate() const final override;
-  virtual bool passed_cut() const final override;
-  virtual double get_weight() const final override;
+  virtual bool passed_decision() const final override;
+
+protected:
+  virtual bool calculate_cut() const final override;
+  virtual double calculate_weight() const final override;
 };
 
 } // namespace queryosity
@@ -26,12 +29,16 @@ inline double queryosity::selection::cut::calculate() const {
   return this->passed_cut();
 }
 
-inline bool queryosity::selection::cut::passed_cut() const {
+inline bool queryosity::selection::cut::passed_decision() const {
+  return m_decision.value();
+}
+
+inline bool queryosity::selection::cut::calculate_cut() const {
   return this->m_preselection
-             ? this->m_preselection->passed_cut() && m_decision.value()
-             : m_decision.value();
+             ? this->m_preselection->passed_cut() && this->passed_decision()
+             : this->passed_decision();
 }
 
-inline double queryosity::selection::cut::get_weight() const {
+inline double queryosity::selection::cut::calculate_weight() const {
   return this->m_preselection ? this->m_preselection->get_weight() : 1.0;
 }
\ No newline at end of file
@@ -37,10 +37,10 @@ public:
 
 protected:
   template <typename Sel>
-  auto add_selection(std::unique_ptr<Sel> selection) -> Sel *;
+  auto add_selection(Sel *selection) -> Sel *;
 
 protected:
-  std::vector<std::unique_ptr<selection::node>> m_selections; //!
+  std::vector<selection::node *> m_selections; //!
 };
 
 } // namespace queryosity
@@ -53,8 +53,9 @@ template <typename Sel, typename Val>
 auto queryosity::selection::cutflow::apply(selection::node const *prev,
                                            column::valued<Val> const &dec)
     -> selection::node * {
-  auto sel = std::make_unique<Sel>(prev, column::variable<double>(dec));
-  return this->add_selection(std::move(sel));
+  auto sel = m_arena.make<Sel>(prev, column::variable<double>(dec));
+  this->add_dependencies(sel, {prev, &dec});
+  return this->add_selection(sel);
 }
 
 template <typename Sel, typename Ret, typename... Args>
@@ -79,15 +80,19 @@ template <typename Sel, typename Def, typename... Cols>
 auto queryosity::selection::cutflow::apply(
     selection::applicator<Sel, Def> const &calc, Cols const &...cols)
     -> selection::node * {
-  auto [sel, col] = calc.apply(cols...);
-  this->add_column(std::move(col));
-  return this->add_selection(std::move(sel));
+  auto [sel, col] = calc.apply(m_arena, cols...);
+  this->add_dependencies(col, {&cols...});
+  this->add_dependencies(sel, {calc.get_previous(), col});
+  this->add_column(col);
+  if constexpr (column::is_batch_definition_v<Def>)
+    this->add_gather(col);
+  return this->add_selection(sel);
 }
 
 template <typename Sel>
-auto queryosity::selection::cutflow::add_selection(std::unique_ptr<Sel> sel)
-    -> Sel * {
-  auto out = sel.get();
-  m_selections.push_back(std::move(sel));
-  return out;
+auto queryosity::selection::cutflow::add_selection(Sel *sel) -> Sel * {
+  sel->set_epoch(&m_epoch);
+  this->add_execute(sel);
+  m_selections.push_back(sel);
+  return sel;
 }
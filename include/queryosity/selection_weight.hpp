@@ -15,8 +15,11 @@ public:
 
 public:
   virtual double calculate() const final override;
-  virtual bool passed_cut() const final override;
-  virtual double get_weight() const final override;
+  virtual bool passed_decision() const final override;
+
+protected:
+  virtual bool calculate_cut() const final override;
+  virtual double calculate_weight() const final override;
 };
 
 } // namespace queryosity
@@ -29,11 +32,15 @@ inline double queryosity::selection::weight::calculate() const {
   return this->get_weight();
 }
 
-inline bool queryosity::selection::weight::passed_cut() const {
+inline bool queryosity::selection::weight::passed_decision() const {
+  return true;
+}
+
+inline bool queryosity::selection::weight::calculate_cut() const {
   return this->m_preselection ? this->m_preselection->passed_cut() : true;
 }
 
-inline double queryosity::selection::weight::get_weight() const {
+inline double queryosity::selection::weight::calculate_weight() const {
   return this->m_preselection
              ? this->m_preselection->get_weight() * m_decision.value()
              : m_decision.value();
@@ -6,6 +6,7 @@
 #include "selection.hpp"
 
 #include <cmath>
+#include <vector>
 
 namespace queryosity {
 
@@ -28,6 +29,8 @@ public:
   virtual ~counter() = default;
 
   virtual void count(double w) final override;
+  virtual void count_many(double w, unsigned long long n) final override;
+  virtual bool is_entrywise() const final override;
   virtual count_t result() const final override;
   virtual void finalize(unsigned int) final override;
   virtual count_t
@@ -54,6 +57,48 @@ protected:
   std::tuple<Sels...> m_selections;
 };
 
+/**
+ * @brief Yields at many selections, counted by one query.
+ * @details The yields are kept in one contiguous array, filled as each entry
+ * passes down the selections, and merged across slots once at the end.
+ */
+class reporter : public query::aggregation<std::vector<count_t>> {
+
+public:
+  reporter() = default;
+  virtual ~reporter() = default;
+
+  virtual void initialize(unsigned int slot, unsigned long long begin,
+                          unsigned long long end) final override;
+  virtual void count(double w) final override;
+  virtual void count_at(size_t isel, double w) final override;
+  virtual std::vector<count_t> result() const final override;
+  virtual std::vector<count_t>
+  merge(std::vector<std::vector<count_t>> const &results) const final override;
+
+protected:
+  // squared errors are summed until the result is taken
+  std::vector<count_t> m_cnts;
+};
+
+/**
+ * @brief Argument for the yields of many selections as one query.
+ * @tparam Sels Lazy selection nodes.
+ * @details Without any selections, the yields of all nominal selections
+ * applied so far are reported in the order they were applied.
+ */
+template <typename... Sels> struct report {
+
+public:
+  report(Sels const &...sels);
+  ~report() = default;
+
+  auto make(dataflow &df) const;
+
+protected:
+  std::tuple<Sels...> m_selections;
+};
+
 } // namespace selection
 
 } // namespace queryosity
@@ -64,6 +109,17 @@ inline void queryosity::selection::counter::count(double w) {
   m_cnt.error += w * w;
 }
 
+inline void queryosity::selection::counter::count_many(double w,
+                                                       unsigned long long n) {
+  m_cnt.entries += n;
+  m_cnt.value += n * w;
+  m_cnt.error += n * w * w;
+}
+
+inline bool queryosity::selection::counter::is_entrywise() const {
+  return false;
+}
+
 inline void queryosity::selection::counter::finalize(unsigned int) {
   m_cnt.error = std::sqrt(m_cnt.error);
 }
@@ -96,4 +152,63 @@ auto queryosity::selection::yield<Sels...>::make(dataflow &df) const {
         return df.get(query::output<counter>()).at(sels...);
       },
       m_selections);
-}
\ No newline at end of file
+}
+inline void queryosity::selection::reporter::initialize(unsigned int,
+                                                        unsigned long long,
+                                                        unsigned long long) {
+  // counts carry over between the parts of a slot
+  m_cnts.resize(m_selections.size(), count_t{0, 0.0, 0.0});
+}
+
+inline void queryosity::selection::reporter::count(double w) {
+  this->count_at(0, w);
+}
+
+inline void queryosity::selection::reporter::count_at(size_t isel, double w) {
+  auto &cnt = m_cnts[isel];
+  cnt.entries++;
+  cnt.value += w;
+  cnt.error += w * w;
+}
+
+inline std::vector<queryosity::selection::count_t>
+queryosity::selection::reporter::result() const {
+  // (none counted if the slot was not handed any entries)
+  std::vector<count_t> cnts(m_selections.size(), count_t{0, 0.0, 0.0});
+  for (size_t isel = 0; isel < m_cnts.size(); ++isel) {
+    cnts[isel] = {m_cnts[isel].entries, m_cnts[isel].value,
+                  std::sqrt(m_cnts[isel].error)};
+  }
+  return cnts;
+}
+
+inline std::vector<queryosity::selection::count_t>
+queryosity::selection::reporter::merge(
+    std::vector<std::vector<count_t>> const &results) const {
+  std::vector<count_t> sum(m_selections.size(), count_t{0, 0.0, 0.0});
+  for (auto const &cnts : results) {
+    for (size_t isel = 0; isel < cnts.size(); ++isel) {
+      sum[isel].entries += cnts[isel].entries;
+      sum[isel].value += cnts[isel].value;
+      sum[isel].error += cnts[isel].error * cnts[isel].error;
+    }
+  }
+  for (auto &cnt : sum) {
+    cnt.error = std::sqrt(cnt.error);
+  }
+  return sum;
+}
+
+template <typename... Sels>
+queryosity::selection::report<Sels...>::report(Sels const &...sels)
+    : m_selections(sels...) {}
+
+template <typename... Sels>
+auto queryosity::selection::report<Sels...>::make(dataflow &df) const {
+  return std::apply(
+      [&df](Sels const &...sels) {
+        return df._book(df.get(query::output<reporter>()),
+                        std::vector<lazy<selection::node>>{sels...});
+      },
+      m_selections);
+}
@@ -0,0 +1,1491 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <queryosity.hpp>
+
+#include <queryosity/wsum.hpp>
+
+using dataflow = qty::dataflow;
+namespace multithread = qty::multithread;
+namespace dataset = qty::dataset;
+namespace column = qty::column;
+namespace query = qty::query;
+namespace selection = qty::selection;
+
+// dataset of entry numbers split into many small parts
+class entries : public dataset::reader<entries>
+{
+public:
+    class number : public column::reader<unsigned long long>
+    {
+    public:
+        virtual const unsigned long long &read(unsigned int, unsigned long long entry) const override
+        {
+            m_entry = entry;
+            return m_entry;
+        }
+
+    protected:
+        mutable unsigned long long m_entry;
+    };
+
+public:
+    entries(unsigned long long nparts, unsigned long long nentries_per_part)
+        : m_nparts(nparts), m_nentries_per_part(nentries_per_part) {}
+
+    virtual void parallelize(unsigned int) override {}
+
+    virtual std::vector<std::pair<unsigned long long, unsigned long long>> partition() override
+    {
+        std::vector<std::pair<unsigned long long, unsigned long long>> parts;
+        for (unsigned long long ipart = 0; ipart < m_nparts; ++ipart)
+        {
+            parts.emplace_back(ipart * m_nentries_per_part, (ipart + 1) * m_nentries_per_part);
+        }
+        return parts;
+    }
+
+    template <typename T>
+    std::unique_ptr<number> read(unsigned int, const std::string &) const
+    {
+        return std::make_unique<number>();
+    }
+
+protected:
+    unsigned long long m_nparts;
+    unsigned long long m_nentries_per_part;
+};
+
+// dataset executed one block at a time
+class blocks : public dataset::reader<blocks>
+{
+public:
+    blocks(unsigned long long nparts, unsigned long long nentries_per_part, std::vector<std::pair<unsigned long long, unsigned long long>> &executed)
+        : m_entries(nparts, nentries_per_part), m_executed(executed) {}
+
+    virtual void parallelize(unsigned int) override {}
+
+    virtual std::vector<std::pair<unsigned long long, unsigned long long>> partition() override
+    {
+        return m_entries.partition();
+    }
+
+    template <typename T>
+    std::unique_ptr<entries::number> read(unsigned int, const std::string &) const
+    {
+        return std::make_unique<entries::number>();
+    }
+
+    virtual bool is_batched() const override { return true; }
+
+    virtual void execute(unsigned int, unsigned long long entry) override
+    {
+        m_executed.emplace_back(entry, entry + 1);
+    }
+
+    virtual void execute_batch(unsigned int, unsigned long long begin, unsigned long long end) override
+    {
+        m_executed.emplace_back(begin, end);
+    }
+
+protected:
+    entries m_entries;
+    std::vector<std::pair<unsigned long long, unsigned long long>> &m_executed;
+};
+
+// dataset that records the entries it is executed for
+class steps : public dataset::reader<steps>
+{
+public:
+    steps(unsigned long long nparts, unsigned long long nentries_per_part, std::vector<unsigned long long> &executed)
+        : m_entries(nparts, nentries_per_part), m_executed(executed) {}
+
+    virtual void parallelize(unsigned int) override {}
+
+    virtual std::vector<std::pair<unsigned long long, unsigned long long>> partition() override
+    {
+        return m_entries.partition();
+    }
+
+    template <typename T>
+    std::unique_ptr<entries::number> read(unsigned int, const std::string &) const
+    {
+        return std::make_unique<entries::number>();
+    }
+
+    virtual void execute(unsigned int, unsigned long long entry) override
+    {
+        m_executed.push_back(entry);
+    }
+
+protected:
+    entries m_entries;
+    std::vector<unsigned long long> &m_executed;
+};
+
+TEST_CASE("work-stealing of dataset parts")
+{
+    const unsigned int nslots = 4;
+    const unsigned long long nparts = 64;
+    const unsigned long long nentries_per_part = 10;
+    const unsigned long long nentries = nparts * nentries_per_part;
+
+    dataflow df(multithread::enable(nslots));
+    auto ds = df.load(dataset::input<entries>(nparts, nentries_per_part));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    // entries in the first quarter of the dataset are much more expensive
+    auto x = df.define(column::expression([nentries](column::observable<unsigned long long> i)
+                                          {
+        if (i.value() < nentries / 4)
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        return double(i.value()); }))(entry);
+
+    auto all = df.filter(column::constant(true));
+    auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(all);
+
+    CHECK(sumx.result() == double(nentries * (nentries - 1) / 2));
+}
+
+// needs more than one slot, which are capped by the hardware concurrency
+TEST_CASE("idle time of each slot" * doctest::skip(std::thread::hardware_concurrency() < 2))
+{
+    const unsigned int nslots = std::min(4u, std::thread::hardware_concurrency());
+
+    dataflow df(multithread::enable(nslots));
+    auto ds = df.load(dataset::input<entries>(64, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    // only the first part is expensive, for which the other slots wait
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          {
+        if (i.value() < 10)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return double(i.value()); }))(entry);
+    auto all = df.filter(column::constant(true));
+    df.get(query::output<qty::wsum>()).fill(x).at(all).result();
+
+    auto const &idle_times = df.get_idle_times();
+    REQUIRE(idle_times.size() == nslots);
+    REQUIRE(idle_times.size() > 1);
+    double total_idle = 0.0;
+    for (unsigned int islot = 0; islot < idle_times.size(); ++islot)
+    {
+        CHECK(idle_times[islot].count() >= 0.0);
+        total_idle += idle_times[islot].count();
+    }
+    CHECK(total_idle > 0.0);
+}
+
+TEST_CASE("scheduler hands out every part once")
+{
+    const unsigned int nslots = 4;
+    std::vector<std::pair<unsigned long long, unsigned long long>> parts;
+    for (unsigned long long ipart = 0; ipart < 37; ++ipart)
+    {
+        parts.emplace_back(ipart, ipart + 1);
+    }
+
+    dataset::scheduler sched(parts, nslots);
+    std::vector<std::vector<unsigned long long>> taken(nslots);
+    std::vector<std::thread> threads;
+    for (unsigned int islot = 0; islot < nslots; ++islot)
+    {
+        threads.emplace_back([&sched, &taken, islot]()
+                             {
+            std::pair<unsigned long long, unsigned long long> part;
+            while (sched.next(islot, part)) {
+                // slot 0 is slow, so that others have to steal from it
+                if (islot == 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                taken[islot].push_back(part.first);
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<unsigned long long> all;
+    for (auto const &slot_taken : taken)
+    {
+        all.insert(all.end(), slot_taken.begin(), slot_taken.end());
+    }
+    std::sort(all.begin(), all.end());
+    CHECK(all.size() == parts.size());
+    for (unsigned long long ipart = 0; ipart < all.size(); ++ipart)
+    {
+        CHECK(all[ipart] == ipart);
+    }
+    CHECK(sched.get_idle_times(dataset::scheduler::clock_type::now()).size() == nslots);
+}
+
+TEST_CASE("idle slots steal the last queued part of another")
+{
+    const std::vector<std::pair<unsigned long long, unsigned long long>> parts{{0, 1}, {1, 2}, {2, 3}, {3, 4}};
+    dataset::scheduler sched(parts, 2);
+    std::pair<unsigned long long, unsigned long long> part;
+
+    // slot 0 is busy with its first part, with one more queued behind it
+    REQUIRE(sched.next(0, part));
+    CHECK(part.first == 0);
+    // slot 1 runs through its own share...
+    REQUIRE(sched.next(1, part));
+    CHECK(part.first == 2);
+    REQUIRE(sched.next(1, part));
+    CHECK(part.first == 3);
+    // ... then takes the part slot 0 has not started yet
+    REQUIRE(sched.next(1, part));
+    CHECK(part.first == 1);
+    CHECK_FALSE(sched.next(0, part));
+    CHECK_FALSE(sched.next(1, part));
+}
+
+TEST_CASE("worker threads are reused across runs")
+{
+    dataflow df(multithread::enable(4));
+    auto ds = df.load(dataset::input<entries>(16, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    std::mutex mutex;
+    std::set<std::thread::id> workers;
+    auto x = df.define(column::expression([&mutex, &workers](column::observable<unsigned long long> i)
+                                          {
+        std::lock_guard<std::mutex> lock(mutex);
+        workers.insert(std::this_thread::get_id());
+        return double(i.value()); }))(entry);
+    auto all = df.filter(column::constant(true));
+
+    df.get(query::output<qty::wsum>()).fill(x).at(all).result();
+    auto workers_first = workers;
+    workers.clear();
+
+    // booking a new query triggers another run
+    df.get(query::output<qty::wsum>()).fill(x).at(all).result();
+    CHECK(workers == workers_first);
+    CHECK(workers.count(std::this_thread::get_id()) == 0);
+}
+
+TEST_CASE("pool with more workers than tasks")
+{
+    multithread::pool pool(8);
+    std::atomic<unsigned int> ncalled = 0;
+    for (unsigned int irun = 0; irun < 1000; ++irun)
+    {
+        // idle workers may wake up after the run has finished
+        std::vector<std::function<void()>> tasks(irun % 3, [&ncalled]()
+                                                 { ++ncalled; });
+        pool.run(tasks);
+    }
+    CHECK(ncalled == 333 * 1 + 333 * 2);
+}
+
+TEST_CASE("block-at-a-time execution")
+{
+    const unsigned long long nparts = 4;
+    const unsigned long long nentries_per_part = 10;
+    const unsigned long long nentries = nparts * nentries_per_part;
+
+    std::vector<std::pair<unsigned long long, unsigned long long>> executed;
+    dataflow df(dataset::batch(4));
+    auto ds = df.load(dataset::input<blocks>(nparts, nentries_per_part, executed));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return double(i.value()); }))(entry);
+    auto all = df.filter(column::constant(true));
+    auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(all);
+
+    // unbatched actions are still executed entry-by-entry
+    CHECK(sumx.result() == double(nentries * (nentries - 1) / 2));
+
+    // each part is split into blocks of (at most) 4 entries
+    REQUIRE(executed.size() == nparts * 3);
+    for (unsigned long long ipart = 0; ipart < nparts; ++ipart)
+    {
+        auto first = ipart * nentries_per_part;
+        CHECK(executed[ipart * 3 + 0] == std::make_pair(first, first + 4));
+        CHECK(executed[ipart * 3 + 1] == std::make_pair(first + 4, first + 8));
+        CHECK(executed[ipart * 3 + 2] == std::make_pair(first + 8, first + 10));
+    }
+}
+
+// column executed once per block without gathering its inputs
+class hasty : public column::definition<double(unsigned long long)>
+{
+public:
+    virtual double evaluate(column::observable<unsigned long long> i) const override
+    {
+        return double(i.value());
+    }
+
+    virtual bool is_batched() const override { return true; }
+};
+
+TEST_CASE("batched actions reading unbatched sources are rejected")
+{
+    dataflow df{dataset::batch(4)};
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::definition<hasty>())(entry);
+    auto all = df.filter(column::constant(true));
+    auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(all);
+    CHECK_THROWS_AS(sumx.result(), std::logic_error);
+}
+
+// column that counts the entries it is executed for
+class counted : public column::definition<double(unsigned long long)>
+{
+public:
+    counted(unsigned long long &nexecuted) : m_nexecuted(nexecuted) {}
+
+    virtual void execute(unsigned int slot, unsigned long long entry) override
+    {
+        ++m_nexecuted;
+        column::definition<double(unsigned long long)>::execute(slot, entry);
+    }
+
+    virtual double evaluate(column::observable<unsigned long long> i) const override
+    {
+        return double(i.value());
+    }
+
+protected:
+    unsigned long long &m_nexecuted;
+};
+
+TEST_CASE("unreachable columns are not executed")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(4, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    unsigned long long nx = 0, ny = 0;
+    auto x = df.define(column::definition<counted>(std::ref(nx)))(entry);
+    auto y = df.define(column::definition<counted>(std::ref(ny)))(entry);
+    auto all = df.filter(column::constant(true));
+
+    df.get(query::output<qty::wsum>()).fill(x).at(all).result();
+    CHECK(nx == 40);
+    CHECK(ny == 0);
+
+    // x is no longer needed once its query has run
+    df.get(query::output<qty::wsum>()).fill(y).at(all).result();
+    CHECK(nx == 40);
+    CHECK(ny == 40);
+}
+
+// calculation that counts how many times it is calculated
+class ticking : public column::calculation<int>
+{
+public:
+    virtual int calculate() const override { return ++m_ncalculated; }
+
+protected:
+    mutable int m_ncalculated = 0;
+};
+
+TEST_CASE("columns are computed only when read, once per entry")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(4, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    unsigned long long ncomputed = 0;
+    auto x = df.define(column::expression([&](column::observable<unsigned long long> i)
+                                          { ++ncomputed; return double(i.value()); }))(entry);
+    auto even = df.filter(column::expression([](column::observable<unsigned long long> i)
+                                             { return i.value() % 2 == 0; }))(entry);
+    // x is read twice, only at even entries
+    auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(even);
+    auto sumx2 = df.get(query::output<qty::wsum>()).fill(x).at(even);
+
+    // each entry sees its own value
+    CHECK(sumx.result() == double(2 * (20 * 19 / 2)));
+    CHECK(sumx2.result() == sumx.result());
+    CHECK(ncomputed == 20);
+
+    // without an epoch, calculated on every access
+    ticking t;
+    CHECK(t.value() == 1);
+    CHECK(t.value() == 2);
+}
+
+// column that logs its identifier whenever it is executed
+class logged : public column::definition<double(double)>
+{
+public:
+    logged(int id, std::vector<int> &log) : m_id(id), m_log(log) {}
+
+    virtual void execute(unsigned int slot, unsigned long long entry) override
+    {
+        m_log.push_back(m_id);
+        column::definition<double(double)>::execute(slot, entry);
+    }
+
+    virtual double evaluate(column::observable<double> x) const override
+    {
+        return x.value();
+    }
+
+protected:
+    int m_id;
+    std::vector<int> &m_log;
+};
+
+TEST_CASE("columns are executed in the order of the plan")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 5));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return double(i.value()); }))(entry);
+
+    std::vector<int> log;
+    auto a = df.define(column::definition<logged>(1, std::ref(log)))(x);
+    auto unused = df.define(column::definition<logged>(2, std::ref(log)))(x);
+    auto b = df.define(column::definition<logged>(3, std::ref(log)))(a);
+    auto c = df.define(column::definition<logged>(4, std::ref(log)))(b);
+    auto all = df.filter(column::constant(true));
+    auto sum = df.get(query::output<qty::wsum>()).fill(c).at(all);
+
+    CHECK(sum.result() == 10 * 9 / 2);
+    // inputs before the columns that need them, once per entry
+    std::vector<int> expected;
+    for (int ientry = 0; ientry < 10; ++ientry)
+    {
+        expected.insert(expected.end(), {1, 3, 4});
+    }
+    CHECK(log == expected);
+}
+
+TEST_CASE("queries are counted down the selection tree")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(4, 25));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return double(i.value()); }))(entry);
+
+    auto even = df.filter(column::expression([](column::observable<unsigned long long> i)
+                                             { return i.value() % 2 == 0; }))(entry);
+    auto two = df.define(column::constant(2.0));
+    auto even_weighted = even.weight(two);
+    auto even_small = even_weighted.filter(column::expression([](column::observable<unsigned long long> i)
+                                                              { return i.value() < 10; }))(entry);
+    auto odd = df.filter(column::expression([](column::observable<unsigned long long> i)
+                                            { return i.value() % 2 == 1; }))(entry);
+
+    // booked out of order of the selections
+    auto sum_even_small = df.get(query::output<qty::wsum>()).fill(x).at(even_small);
+    auto sum_odd = df.get(query::output<qty::wsum>()).fill(x).at(odd);
+    auto sum_even = df.get(query::output<qty::wsum>()).fill(x).at(even);
+    auto sum_even_weighted = df.get(query::output<qty::wsum>()).fill(x).at(even_weighted);
+
+    CHECK(sum_even_small.result() == 2.0 * (0 + 2 + 4 + 6 + 8));
+    CHECK(sum_odd.result() == 2500.0);
+    CHECK(sum_even.result() == 2450.0);
+    CHECK(sum_even_weighted.result() == 4900.0);
+}
+
+// column that remembers which threads constructed and executed it
+class located : public column::definition<double(unsigned long long)>
+{
+public:
+    located(std::set<std::pair<std::thread::id, std::thread::id>> &threads, std::mutex &mutex)
+        : m_constructed(std::this_thread::get_id()), m_threads(threads), m_mutex(mutex) {}
+
+    virtual void initialize(unsigned int, unsigned long long, unsigned long long) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_threads.emplace(m_constructed, std::this_thread::get_id());
+    }
+
+    virtual double evaluate(column::observable<unsigned long long> i) const override
+    {
+        return double(i.value());
+    }
+
+protected:
+    std::thread::id m_constructed;
+    std::set<std::pair<std::thread::id, std::thread::id>> &m_threads;
+    std::mutex &m_mutex;
+};
+
+TEST_CASE("pinned slots are built by their own threads")
+{
+    std::mutex mutex;
+    std::set<std::pair<std::thread::id, std::thread::id>> threads;
+
+    dataflow df(multithread::enable(4, multithread::affinity::core));
+    auto ds = df.load(dataset::input<entries>(16, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::definition<located>(std::ref(threads), std::ref(mutex)))(entry);
+    auto all = df.filter(column::constant(true));
+    auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(all);
+
+    CHECK(sumx.result() == double(160 * 159 / 2));
+    REQUIRE(!threads.empty());
+    for (auto const &[constructed, executed] : threads)
+    {
+        CHECK(constructed == executed);
+        CHECK(constructed != std::this_thread::get_id());
+    }
+}
+
+TEST_CASE("asynchronous analysis")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(10, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    auto x = df.define(column::expression([&mutex, &threads](column::observable<unsigned long long> i)
+                                          {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+        return double(i.value()); }))(entry);
+    auto all = df.filter(column::constant(true));
+    auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(all);
+
+    auto analysis = df.analyze_async();
+    CHECK(analysis.valid());
+
+    // progress can be polled while the analysis runs
+    double progress = 0.0;
+    while (analysis.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+    {
+        auto polled = df.get_progress();
+        CHECK(polled >= progress);
+        CHECK(polled <= 1.0);
+        progress = polled;
+    }
+    CHECK(df.get_progress() == 1.0);
+    auto workers = threads;
+    CHECK(workers.size() == 1);
+    CHECK(workers.count(std::this_thread::get_id()) == 0);
+
+    // booking another query waits for the analysis in progress
+    auto sumx2 = df.get(query::output<qty::wsum>()).fill(x).at(all);
+    CHECK(analysis.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+
+    CHECK(sumx.result() == double(100 * 99 / 2));
+    CHECK(sumx2.result() == double(100 * 99 / 2));
+
+    // nothing left to analyze
+    CHECK(df.analyze_async().wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+
+    // analyses in the background are run by the same worker thread
+    auto sumx3 = df.get(query::output<qty::wsum>()).fill(x).at(all);
+    threads.clear();
+    df.analyze_async().wait();
+    CHECK(sumx3.result() == double(100 * 99 / 2));
+    CHECK(threads == workers);
+}
+
+TEST_CASE("failed asynchronous analysis")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          {
+        if (i.value() == 15)
+            throw std::runtime_error("bad entry");
+        return double(i.value()); }))(entry);
+    auto all = df.filter(column::constant(true));
+    df.get(query::output<qty::wsum>()).fill(x).at(all);
+    df.analyze_async().wait();
+
+    // the failure is reported by whatever waits for the analysis next
+    CHECK_THROWS_AS(df.get(query::output<qty::wsum>()).fill(x).at(all), std::runtime_error);
+}
+
+TEST_CASE("failed asynchronous re-analysis")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return double(i.value()); }))(entry);
+    auto bad = df.define(column::expression([](column::observable<unsigned long long> i)
+                                            {
+        if (i.value() == 15)
+            throw std::runtime_error("bad entry");
+        return double(i.value()); }))(entry);
+    auto all = df.filter(column::constant(true));
+    auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(all);
+    CHECK(sumx.result() == 20 * 19 / 2);
+    df.get(query::output<qty::wsum>()).fill(bad).at(all);
+    df.analyze_async().wait();
+
+    // even by the result of a query from the previous run
+    CHECK_THROWS_AS(sumx.result(), std::runtime_error);
+}
+
+TEST_CASE("planning of dataset parts")
+{
+    using parts_t = std::vector<std::pair<unsigned long long, unsigned long long>>;
+    parts_t parts{{0, 2}, {2, 4}, {4, 5}, {5, 25}, {25, 27}};
+
+    SUBCASE("split and merge")
+    {
+        CHECK(dataset::partition::plan(parts, 6) == parts_t{{0, 5}, {5, 10}, {10, 15}, {15, 20}, {20, 25}, {25, 27}});
+    }
+
+    SUBCASE("merge only")
+    {
+        CHECK(dataset::partition::plan(parts, 6, {parts}) == parts_t{{0, 5}, {5, 25}, {25, 27}});
+    }
+
+    SUBCASE("split between parts kept whole")
+    {
+        // e.g. clusters of a dataset read alongside one that can be split anywhere
+        parts_t whole{{0, 5}, {5, 9}, {9, 12}, {12, 20}, {20, 25}, {25, 27}};
+        CHECK(dataset::partition::plan(parts, 6, {whole}) == parts_t{{0, 5}, {5, 9}, {9, 12}, {12, 20}, {20, 25}, {25, 27}});
+        CHECK(dataset::partition::plan(parts, 8, {whole}) == parts_t{{0, 5}, {5, 12}, {12, 20}, {20, 25}, {25, 27}});
+    }
+
+    SUBCASE("unchanged")
+    {
+        CHECK(dataset::partition::plan(parts, 0) == parts);
+    }
+
+    SUBCASE("processed")
+    {
+        dataflow df(dataset::chunk(7));
+        auto ds = df.load(dataset::input<entries>(4, 10));
+        auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+        auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                              { return double(i.value()); }))(entry);
+        auto all = df.filter(column::constant(true));
+        auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(all);
+        CHECK(sumx.result() == double(40 * 39 / 2));
+    }
+}
+
+TEST_CASE("re-analysis runs only the new queries")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(4, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    unsigned long long nx = 0, ny = 0;
+    auto x = df.define(column::definition<counted>(std::ref(nx)))(entry);
+    auto y = df.define(column::definition<counted>(std::ref(ny)))(entry);
+    auto all = df.filter(column::constant(true));
+
+    auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(all);
+    df.analyze_async().wait();
+    CHECK(nx == 40);
+
+    // booking a new query does not invalidate the existing result
+    auto sumy = df.get(query::output<qty::wsum>()).fill(y).at(all);
+    CHECK(sumx.result() == double(40 * 39 / 2));
+    CHECK(ny == 0);
+
+    CHECK(sumy.result() == double(40 * 39 / 2));
+    CHECK(nx == 40);
+    CHECK(ny == 40);
+}
+
+// column evaluated over spans of entries
+class doubled : public column::batch_definition<double(double)>
+{
+public:
+    doubled(std::vector<size_t> &sizes) : m_sizes(sizes) {}
+
+    virtual void evaluate(column::span<double> out, column::span<double const> x) const override
+    {
+        m_sizes.push_back(out.size());
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            out[i] = 2 * x[i];
+        }
+    }
+
+protected:
+    std::vector<size_t> &m_sizes;
+};
+
+TEST_CASE("batch definitions over spans of entries")
+{
+    auto run = [](unsigned long long nbatch, std::vector<size_t> &sizes)
+    {
+        dataflow df{dataset::batch(nbatch)};
+        auto ds = df.load(dataset::input<entries>(2, 10));
+        auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+        auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                              { return double(i.value()); }))(entry);
+        // entry-by-entry -> batch -> entry-by-entry -> batch
+        auto x2 = df.define(column::definition<doubled>(std::ref(sizes)))(x);
+        auto x2p1 = df.define(column::expression([](column::observable<double> y)
+                                                 { return y.value() + 1; }))(x2);
+        auto x4p2 = df.define(column::definition<doubled>(std::ref(sizes)))(x2p1);
+        auto all = df.filter(column::constant(true));
+        auto sum2 = df.get(query::output<qty::wsum>()).fill(x2).at(all);
+        auto sum4 = df.get(query::output<qty::wsum>()).fill(x4p2).at(all);
+        return std::make_pair(sum2.result(), sum4.result());
+    };
+
+    const double sumx = 20 * 19 / 2;
+
+    std::vector<size_t> sizes;
+    CHECK(run(0, sizes) == std::make_pair(2 * sumx, 4 * sumx + 2 * 20));
+    CHECK(sizes.size() == 2 * 20);
+    CHECK(std::all_of(sizes.begin(), sizes.end(), [](size_t n)
+                      { return n == 1; }));
+
+    sizes.clear();
+    CHECK(run(4, sizes) == std::make_pair(2 * sumx, 4 * sumx + 2 * 20));
+    // each part of 10 entries is split into blocks of 4, 4, 2
+    const std::vector<size_t> part_sizes{4, 4, 4, 4, 2, 2};
+    REQUIRE(sizes.size() == 2 * part_sizes.size());
+    CHECK(std::equal(part_sizes.begin(), part_sizes.end(), sizes.begin()));
+    CHECK(std::equal(part_sizes.begin(), part_sizes.end(), sizes.begin() + part_sizes.size()));
+}
+
+TEST_CASE("inputs of batch definitions are gathered once per block")
+{
+    dataflow df{dataset::batch(4)};
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    std::atomic<size_t> ncalled{0};
+    auto x = df.define(column::expression([&](column::observable<unsigned long long> i)
+                                          { ++ncalled; return double(i.value()); }))(entry);
+    // independent of each other: gathered together
+    std::vector<size_t> sizes;
+    auto x2 = df.define(column::definition<doubled>(std::ref(sizes)))(x);
+    auto x2b = df.define(column::definition<doubled>(std::ref(sizes)))(x);
+    auto x2c = df.define(column::definition<doubled>(std::ref(sizes)))(x);
+    auto all = df.filter(column::constant(true));
+    auto sum2 = df.get(query::output<qty::wsum>()).fill(x2).at(all);
+    auto sum2b = df.get(query::output<qty::wsum>()).fill(x2b).at(all);
+    auto sum2c = df.get(query::output<qty::wsum>()).fill(x2c).at(all);
+
+    const double sumx = 20 * 19 / 2;
+    CHECK(sum2.result() == 2 * sumx);
+    CHECK(sum2b.result() == 2 * sumx);
+    CHECK(sum2c.result() == 2 * sumx);
+    CHECK(sizes.size() == 3 * 6);
+    CHECK(ncalled == 20);
+}
+
+TEST_CASE("sources are executed once per entry over blocks")
+{
+    std::vector<unsigned long long> executed;
+    dataflow df{dataset::batch(4)};
+    auto ds = df.load(dataset::input<steps>(2, 10, executed));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return double(i.value()); }))(entry);
+    // read only to be gathered for the batch definition
+    std::vector<size_t> sizes;
+    auto x2 = df.define(column::definition<doubled>(std::ref(sizes)))(x);
+    auto all = df.filter(column::constant(true));
+    auto sum2 = df.get(query::output<qty::wsum>()).fill(x2).at(all);
+
+    CHECK(sum2.result() == 20 * 19);
+    std::sort(executed.begin(), executed.end());
+    REQUIRE(executed.size() == 20);
+    for (unsigned long long i = 0; i < 20; ++i)
+    {
+        CHECK(executed[i] == i);
+    }
+}
+
+TEST_CASE("arena allocation of actions")
+{
+    struct logged
+    {
+        logged(std::vector<int> &log, int id) : m_log(log), m_id(id) {}
+        ~logged() { m_log.push_back(m_id); }
+        std::vector<int> &m_log;
+        int m_id;
+    };
+
+    std::vector<int> destroyed;
+    {
+        qty::arena mem(256);
+        auto a = mem.make<logged>(destroyed, 0);
+        auto b = mem.make<logged>(destroyed, 1);
+        // placed one after another in creation order
+        CHECK(reinterpret_cast<char *>(b) - reinterpret_cast<char *>(a) == sizeof(logged));
+        // larger objects get their own block
+        auto big = mem.make<std::array<double, 64>>();
+        big->fill(1.0);
+        auto c = mem.adopt(std::make_unique<logged>(destroyed, 2));
+        CHECK(c->m_id == 2);
+    }
+    // destroyed in reverse order
+    CHECK(destroyed == std::vector<int>{2, 1, 0});
+
+    // objects that fail to be constructed are not destroyed
+    struct failing : logged
+    {
+        failing(std::vector<int> &log) : logged(log, 3) { throw std::runtime_error("failed"); }
+    };
+    destroyed.clear();
+    {
+        qty::arena mem(256);
+        mem.make<logged>(destroyed, 0);
+        CHECK_THROWS_AS(mem.make<failing>(destroyed), std::runtime_error);
+        mem.make<logged>(destroyed, 1);
+    }
+    // the base of the failed object is destroyed by its constructor only
+    CHECK(destroyed == std::vector<int>{3, 1, 0});
+}
+
+TEST_CASE("chains of column operators are fused")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    unsigned long long na = 0;
+    auto a = df.define(column::definition<counted>(std::ref(na)))(entry);
+    auto b = df.define(column::constant(1.0));
+    auto c = df.define(column::constant(2.0));
+    auto d = df.define(column::constant(4.0));
+
+    // a is executed once per entry, however many times it appears
+    auto e = (a + b) * c / d - a;
+    auto f = a > b && -a < -c;
+    auto all = df.filter(column::constant(true));
+    auto sume = df.get(query::output<qty::wsum>()).fill(e).at(all);
+    auto sumf = df.get(query::output<qty::wsum>()).fill(f).at(all);
+
+    double expected_e = 0, expected_f = 0;
+    for (unsigned long long i = 0; i < 20; ++i)
+    {
+        expected_e += (i + 1.0) * 2.0 / 4.0 - i;
+        expected_f += (i > 1.0 && -double(i) < -2.0);
+    }
+    CHECK(sume.result() == expected_e);
+    CHECK(sumf.result() == expected_f);
+    CHECK(na == 20);
+}
+
+// value that counts how many times it is multiplied
+struct scaled
+{
+    static inline unsigned long long nmultiplied = 0;
+    double v = 0;
+    operator double() const { return v; }
+};
+
+scaled operator*(scaled const &a, scaled const &b)
+{
+    ++scaled::nmultiplied;
+    return scaled{a.v * b.v};
+}
+
+TEST_CASE("fused columns read by several others are computed once")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return scaled{double(i.value())}; }))(entry);
+    auto one = df.define(column::constant(1.0));
+
+    scaled::nmultiplied = 0;
+    auto a = x * x;
+    auto b = a + one;
+    auto c = a - one;
+    auto all = df.filter(column::constant(true));
+    auto sumb = df.get(query::output<qty::wsum>()).fill(b).at(all);
+    auto sumc = df.get(query::output<qty::wsum>()).fill(c).at(all);
+
+    const double sumx2 = 19 * 20 * 39 / 6;
+    CHECK(sumb.result() == sumx2 + 20);
+    CHECK(sumc.result() == sumx2 - 20);
+    CHECK(scaled::nmultiplied == 20);
+}
+
+TEST_CASE("expressions keep their concrete callable type")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    auto twice = [](column::observable<unsigned long long> i)
+    { return 2.0 * i.value(); };
+    auto x = df.define(column::expression(twice))(entry);
+    static_assert(std::is_same_v<typename decltype(x)::action_type::function_type, decltype(twice)>);
+
+    auto all = df.filter(column::constant(true));
+    CHECK(df.get(query::output<qty::wsum>()).fill(x).at(all).result() == 2.0 * 20 * 19 / 2);
+}
+
+// column of i % 4 values computed in-place, counting its (re-)allocations
+class ramp : public column::inplace_definition<std::vector<double>(unsigned long long)>
+{
+public:
+    ramp(unsigned long long &nallocated) : m_nallocated(nallocated) {}
+
+    virtual void evaluate_into(std::vector<double> &out, column::observable<unsigned long long> i) const override
+    {
+        auto n = i.value() % 4;
+        if (out.capacity() < n)
+            ++m_nallocated;
+        out.resize(n);
+        std::fill(out.begin(), out.end(), 1.0);
+    }
+
+protected:
+    unsigned long long &m_nallocated;
+};
+
+TEST_CASE("in-place definitions re-use their output")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    unsigned long long nallocated = 0;
+    auto v = df.define(column::definition<ramp>(std::ref(nallocated)))(entry);
+    auto n = df.define(column::expression([](column::observable<std::vector<double>> v)
+                                          { return double(v->size()); }))(v);
+
+    auto all = df.filter(column::constant(true));
+    CHECK(df.get(query::output<qty::wsum>()).fill(n).at(all).result() == 5 * (0 + 1 + 2 + 3));
+    CHECK(nallocated <= 3);
+}
+
+// value that counts its conversions to double
+struct tally
+{
+    static inline unsigned long long nconverted = 0;
+    unsigned long long i = 0;
+    operator double() const
+    {
+        ++nconverted;
+        return double(i);
+    }
+};
+
+TEST_CASE("conversions are shared and cached per entry")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return tally{i.value()}; }))(entry);
+
+    auto all = df.filter(column::constant(true));
+    auto [a, b, c] = df.get(query::output<qty::wsum>()).fill(x).at(all, all, all);
+    CHECK(a.result() == 20 * 19 / 2);
+    CHECK(b.result() == 20 * 19 / 2);
+    CHECK(c.result() == 20 * 19 / 2);
+    CHECK(tally::nconverted == 20);
+}
+
+// running sum of its input, i.e. stateful without any arguments
+class summed : public column::definition<double(unsigned long long)>
+{
+public:
+    virtual double evaluate(column::observable<unsigned long long> i) const override
+    {
+        return m_sum += i.value();
+    }
+
+protected:
+    mutable double m_sum = 0;
+};
+
+// input shifted by an offset, which is doubled when varied
+class shifted : public column::definition<double(unsigned long long)>
+{
+public:
+    shifted(double offset) : m_offset(offset) {}
+
+    virtual void vary(const std::string &) override { m_offset *= 2; }
+
+    virtual double evaluate(column::observable<unsigned long long> i) const override
+    {
+        return i.value() + m_offset;
+    }
+
+protected:
+    double m_offset;
+};
+
+TEST_CASE("identical columns are computed once")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto again = ds.read(dataset::column<unsigned long long>("entry"));
+    CHECK(entry.get_slots() == again.get_slots());
+
+    auto twice = [](column::observable<unsigned long long> i)
+    { return 2.0 * i.value(); };
+    auto x = df.define(column::expression(twice))(entry);
+    auto y = df.define(column::expression(twice))(again);
+    CHECK(x.get_slots() == y.get_slots());
+
+    // different inputs
+    auto z = df.define(column::expression(twice))(df.define(column::constant<unsigned long long>(1)));
+    CHECK(x.get_slots() != z.get_slots());
+
+    // references, even to the same object
+    unsigned long long nx = 0, ny = 0;
+    auto cx = df.define(column::definition<counted>(std::ref(nx)))(entry);
+    auto cy = df.define(column::definition<counted>(std::ref(ny)))(entry);
+    auto cz = df.define(column::definition<counted>(std::ref(nx)))(entry);
+    CHECK(cx.get_slots() != cy.get_slots());
+    CHECK(cx.get_slots() != cz.get_slots());
+
+    // no arguments to tell their state apart
+    auto sx = df.define(column::definition<summed>())(entry);
+    auto sy = df.define(column::definition<summed>())(entry);
+    CHECK(sx.get_slots() != sy.get_slots());
+
+    // varied instances are never the nominal one
+    auto v = df.vary(column::definition<shifted>(1.0), {{"same", column::definition<shifted>(1.0)}})(entry);
+    CHECK(v.nominal().get_slots() != v.variation("same").get_slots());
+    auto all = df.filter(column::constant(true));
+    CHECK(df.get(query::output<qty::wsum>()).fill(v.nominal()).at(all).result() == 20 * 19 / 2 + 20 * 1.0);
+}
+
+// sum of i % 4 ones, counted with a temporary in scratch memory
+class scratched : public column::definition<double(unsigned long long)>
+{
+public:
+    scratched(std::set<double const *> &addresses) : m_addresses(addresses) {}
+
+    virtual double evaluate(column::observable<unsigned long long> i) const override
+    {
+        std::pmr::vector<double> ones(this->get_scratch());
+        ones.reserve(4);
+        ones.assign(i.value() % 4, 1.0);
+        m_addresses.insert(ones.data());
+        return std::accumulate(ones.begin(), ones.end(), 0.0);
+    }
+
+protected:
+    std::set<double const *> &m_addresses;
+};
+
+TEST_CASE("scratch memory is reclaimed for each entry")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    std::set<double const *> addresses;
+    auto n = df.define(column::definition<scratched>(std::ref(addresses)))(entry);
+
+    auto all = df.filter(column::constant(true));
+    CHECK(df.get(query::output<qty::wsum>()).fill(n).at(all).result() == 5 * (0 + 1 + 2 + 3));
+    CHECK(addresses.size() == 1);
+}
+
+// needs more than one slot, which are capped by the hardware concurrency
+TEST_CASE("constants are shared across slots" * doctest::skip(std::thread::hardware_concurrency() < 2))
+{
+    dataflow df(multithread::enable(4));
+    auto ds = df.load(dataset::input<entries>(16, 10));
+    auto table = df.define(column::constant(std::vector<double>(1000, 1.0)));
+
+    auto addresses = dataflow::node::invoke([](column::valued<std::vector<double>> *cnst)
+                                            { return &cnst->value(); },
+                                            table);
+    REQUIRE(addresses.size() > 1);
+    CHECK(std::set<std::vector<double> const *>(addresses.begin(), addresses.end()).size() == 1);
+}
+
+TEST_CASE("weights are only computed for entries passing the cuts")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    unsigned long long nweighted = 0;
+    auto even = df.filter(column::expression([](column::observable<unsigned long long> i)
+                                             { return i.value() % 2 == 0; }))(entry);
+    auto weighted = even.weight(column::expression([&nweighted](column::observable<unsigned long long> i)
+                                                   { ++nweighted; return double(i.value()); }))(entry);
+    auto small = weighted.filter(column::expression([](column::observable<unsigned long long> i)
+                                                    { return i.value() < 10; }))(entry);
+
+    auto one = df.define(column::constant(1.0));
+    auto [at_weighted, at_small] = df.get(query::output<qty::wsum>()).fill(one).at(weighted, small);
+    CHECK(at_weighted.result() == 0 + 2 + 4 + 6 + 8 + 10 + 12 + 14 + 16 + 18);
+    CHECK(at_small.result() == 0 + 2 + 4 + 6 + 8);
+    CHECK(nweighted == 10);
+}
+
+// decision that counts how many times it is evaluated
+class tallied : public column::view<double>
+{
+public:
+    tallied(double value, unsigned long long &ncalled) : m_value(value), m_ncalled(ncalled) {}
+
+    virtual const double &value() const override
+    {
+        ++m_ncalled;
+        return m_value;
+    }
+
+protected:
+    double m_value;
+    unsigned long long &m_ncalled;
+};
+
+TEST_CASE("cuts and weights down a chain are calculated once per entry")
+{
+    // cut -> weight -> cut -> weight -> ..., read at its end by many queries
+    const unsigned int depth = 8;
+    const unsigned int nqueries = 16;
+    const unsigned long long nentries = 10;
+
+    column::epoch ep;
+    std::vector<unsigned long long> ncalled(depth, 0);
+    std::vector<std::unique_ptr<tallied>> decisions;
+    std::vector<std::unique_ptr<selection::node>> chain;
+    for (unsigned int i = 0; i < depth; ++i)
+    {
+        auto presel = chain.empty() ? nullptr : chain.back().get();
+        decisions.push_back(std::make_unique<tallied>(i % 2 ? 2.0 : 1.0, ncalled[i]));
+        column::variable<double> dec(*decisions.back());
+        if (i % 2)
+            chain.push_back(std::make_unique<selection::weight>(presel, std::move(dec)));
+        else
+            chain.push_back(std::make_unique<selection::cut>(presel, std::move(dec)));
+        chain.back()->set_epoch(&ep);
+    }
+
+    auto const &last = *chain.back();
+    for (unsigned long long entry = 0; entry < nentries; ++entry)
+    {
+        ep.entry = entry;
+        ++ep.count;
+        for (unsigned int iqry = 0; iqry < nqueries; ++iqry)
+        {
+            REQUIRE(last.passed_cut());
+            CHECK(last.get_weight() == 16.0);
+        }
+    }
+    // each evaluates its decision once from calculate_cut() (cuts) or
+    // calculate_weight() (weights), i.e. each is calculated once per entry
+    for (unsigned int i = 0; i < depth; ++i)
+    {
+        CHECK(ncalled[i] == nentries);
+    }
+}
+
+TEST_CASE("dataset weight scales the queries of each selection once")
+{
+    dataflow df(dataset::weight(0.5));
+    auto ds = df.load(dataset::input<entries>(2, 10));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return double(i.value()); }))(entry);
+
+    auto all = df.filter(column::constant(true));
+    auto two = all.weight(df.define(column::constant(2.0)));
+    auto [a, b] = df.get(query::output<qty::wsum>()).fill(x).at(all, all);
+    auto c = df.get(query::output<qty::wsum>()).fill(x).at(two);
+    CHECK(a.result() == 0.5 * 20 * 19 / 2);
+    CHECK(b.result() == 0.5 * 20 * 19 / 2);
+    CHECK(c.result() == 20 * 19 / 2);
+}
+
+// whether entries are multiples of a number, evaluated over spans of entries
+class multiple_of : public column::batch_definition<double(unsigned long long)>
+{
+public:
+    multiple_of(unsigned long long n) : m_n(n) {}
+
+    virtual void evaluate(column::span<double> out, column::span<unsigned long long const> i) const override
+    {
+        for (size_t k = 0; k < out.size(); ++k)
+        {
+            out[k] = i[k] % m_n == 0;
+        }
+    }
+
+protected:
+    unsigned long long m_n;
+};
+
+TEST_CASE("batched cuts are decided for blocks of entries")
+{
+    auto run = [](unsigned long long nbatch)
+    {
+        dataflow df{dataset::batch(nbatch)};
+        auto ds = df.load(dataset::input<entries>(3, 100));
+        auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+        auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                              { return double(i.value()); }))(entry);
+
+        auto two = df.filter(df.define(column::definition<multiple_of>(2))(entry));
+        auto six = two.filter(df.define(column::definition<multiple_of>(3))(entry));
+        auto weighted = six.weight(x);
+        auto twelve = weighted.filter(df.define(column::definition<multiple_of>(4))(entry));
+        // not batched
+        auto odd = df.filter(column::expression([](column::observable<unsigned long long> i)
+                                                { return i.value() % 2 == 1; }))(entry);
+        auto odd_five = odd.filter(df.define(column::definition<multiple_of>(5))(entry));
+
+        auto [n_two, n_six, n_twelve, n_odd_five] = df.get(selection::yield(two, six, twelve, odd_five));
+        auto [x_six, x_twelve] = df.get(query::output<qty::wsum>()).fill(x).at(six, twelve);
+        return std::vector<double>{double(n_two.result().entries), n_two.result().value,
+                                   double(n_six.result().entries), n_six.result().value,
+                                   double(n_twelve.result().entries), n_twelve.result().value,
+                                   double(n_odd_five.result().entries), n_odd_five.result().value,
+                                   x_six.result(), x_twelve.result()};
+    };
+    // (entries, sum of weights) of yields, sum of x
+    const std::vector<double> expected{150, 150, 50, 50, 25, 12 * 24 * 25 / 2, 30, 30,
+                                       6 * 49 * 50 / 2, 144 * 24 * 25 * 49 / 6};
+    CHECK(run(0) == expected);
+    CHECK(run(128) == expected);
+    CHECK(run(7) == expected);
+}
+
+TEST_CASE("batch definitions applied directly as cuts and weights")
+{
+    auto run = [](unsigned long long nbatch)
+    {
+        dataflow df{dataset::batch(nbatch)};
+        auto ds = df.load(dataset::input<entries>(3, 100));
+        auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+        auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                              { return double(i.value()); }))(entry);
+
+        auto two = df.filter(column::definition<multiple_of>(2))(entry);
+        auto six = two.filter(column::definition<multiple_of>(3))(entry);
+        auto weighted = six.weight(column::definition<multiple_of>(4))(entry);
+        auto [x_two, x_weighted] = df.get(query::output<qty::wsum>()).fill(x).at(two, weighted);
+        return std::make_pair(x_two.result(), x_weighted.result());
+    };
+    // multiples of 2, and those of 12 (weighted by one, others by zero)
+    const auto expected = std::make_pair(2.0 * 149 * 150 / 2, 12.0 * 24 * 25 / 2);
+    CHECK(run(0) == expected);
+    CHECK(run(16) == expected);
+    CHECK(run(7) == expected);
+}
+
+TEST_CASE("entries failing the batched cuts are skipped")
+{
+    auto run = [](unsigned long long nbatch)
+    {
+        dataflow df{dataset::batch(nbatch)};
+        auto ds = df.load(dataset::input<entries>(3, 100));
+        auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+        unsigned long long nexecuted = 0;
+        auto x = df.define(column::definition<counted>(std::ref(nexecuted)))(entry);
+        auto three = df.filter(df.define(column::definition<multiple_of>(3))(entry));
+        auto sumx = df.get(query::output<qty::wsum>()).fill(x).at(three);
+        CHECK(sumx.result() == 3 * 99 * 100 / 2);
+        return nexecuted;
+    };
+    CHECK(run(0) == 300);
+    // only the entries passing the cut are visited one by one
+    CHECK(run(64) == 100);
+}
+
+TEST_CASE("yields of many selections are reported by one query")
+{
+    auto run = [](unsigned long long nbatch)
+    {
+        dataflow df{dataset::weight(0.5), dataset::batch(nbatch)};
+        auto ds = df.load(dataset::input<entries>(3, 100));
+        auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+        auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                              { return double(i.value()); }))(entry);
+
+        auto two = df.filter(df.define(column::definition<multiple_of>(2))(entry));
+        auto six = two.filter(df.define(column::definition<multiple_of>(3))(entry));
+        auto weighted = six.weight(x);
+        auto odd = df.filter(column::expression([](column::observable<unsigned long long> i)
+                                                { return i.value() % 2 == 1; }))(entry);
+
+        auto everything = df.get(selection::report());
+        auto some = df.get(selection::report(weighted, two));
+        auto [y_two, y_six, y_weighted, y_odd] = df.get(selection::yield(two, six, weighted, odd));
+
+        auto report = everything.result();
+        REQUIRE(report.size() == 4);
+        for (auto const &[cnt, yld] : std::vector<std::pair<selection::count_t, selection::count_t>>{
+                 {report[0], y_two.result()},
+                 {report[1], y_six.result()},
+                 {report[2], y_weighted.result()},
+                 {report[3], y_odd.result()}})
+        {
+            CHECK(cnt.entries == yld.entries);
+            CHECK(cnt.value == yld.value);
+        }
+        auto partial = some.result();
+        REQUIRE(partial.size() == 2);
+        CHECK(partial[0].value == 0.5 * 6 * 49 * 50 / 2);
+        CHECK(partial[1].entries == 150);
+        CHECK(partial[1].value == 0.5 * 150);
+        CHECK(partial[1].error == doctest::Approx(std::sqrt(0.25 * 150)));
+    };
+    run(0);
+    run(16);
+}
+
+TEST_CASE("varied selections are left out of the nominal report")
+{
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(3, 100));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto every = df.vary(column::constant<unsigned long long>(2), {{"three", 3}});
+    auto multiple = df.filter(column::expression([](column::observable<unsigned long long> i,
+                                                    column::observable<unsigned long long> n)
+                                                 { return i.value() % n.value() == 0; }))(entry, every);
+    auto odd = multiple.filter(column::expression([](column::observable<unsigned long long> i)
+                                                  { return i.value() % 2 == 1; }))(entry);
+
+    auto report = df.get(selection::report()).result();
+    REQUIRE(report.size() == 2);
+    CHECK(report[0].entries == 150);
+    CHECK(report[1].entries == 0);
+}
+
+// cut that takes a while to decide, counting the entries it is evaluated for
+class costly : public column::definition<double(unsigned long long)>
+{
+public:
+    costly(unsigned long long &nevaluated) : m_nevaluated(nevaluated) {}
+
+    virtual double evaluate(column::observable<unsigned long long> i) const override
+    {
+        ++m_nevaluated;
+        volatile double spin = 0;
+        for (int k = 0; k < 20000; ++k)
+        {
+            spin = spin + k;
+        }
+        return i.value() % 10 != 0;
+    }
+
+protected:
+    unsigned long long &m_nevaluated;
+};
+
+TEST_CASE("chained cuts are reordered by their cost and pass rate")
+{
+    dataflow df(dataset::reorder(100));
+    auto ds = df.load(dataset::input<entries>(4, 250));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return double(i.value()); }))(entry);
+
+    // an expensive cut passing most entries, then a cheap one passing few
+    unsigned long long nevaluated = 0;
+    auto loose = df.filter(df.define(column::definition<costly>(std::ref(nevaluated)))(entry));
+    auto tight = loose.filter(column::expression([](column::observable<unsigned long long> i)
+                                                 { return i.value() % 10 == 1; }))(entry);
+    // cuts with a query in between stay in place
+    auto odd = df.filter(column::expression([](column::observable<unsigned long long> i)
+                                            { return i.value() % 2 == 1; }))(entry);
+    auto odd_three = odd.filter(column::expression([](column::observable<unsigned long long> i)
+                                                   { return i.value() % 3 == 0; }))(entry);
+
+    auto x_tight = df.get(query::output<qty::wsum>()).fill(x).at(tight);
+    auto [n_odd, n_odd_three] = df.get(selection::yield(odd, odd_three));
+
+    // results are the same
+    CHECK(x_tight.result() == 10 * 99 * 100 / 2 + 100);
+    CHECK(n_odd.result().entries == 500);
+    CHECK(n_odd_three.result().entries == 167);
+
+    auto reorderings = df.get_reorderings();
+    REQUIRE(reorderings.size() == 1);
+    REQUIRE(reorderings[0].size() == 1);
+    auto const &reordered = reorderings[0][0];
+    CHECK(reordered.order == std::vector<size_t>{1, 0});
+    CHECK(reordered.rates[0] == doctest::Approx(0.1));
+    CHECK(reordered.rates[1] == doctest::Approx(0.9));
+    CHECK(reordered.costs[0] < reordered.costs[1]);
+    // the expensive cut is evaluated for every sampled entry, then only for
+    // the ones passing the cheap cut
+    CHECK(nevaluated == 100 + 90);
+}
+
+TEST_CASE("varied chained cuts are left out of the reorderings")
+{
+    dataflow df(dataset::reorder(100));
+    auto ds = df.load(dataset::input<entries>(4, 250));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return double(i.value()); }))(entry);
+
+    // the same chain for the nominal and the variation
+    unsigned long long nevaluated = 0;
+    auto loose = df.filter(df.vary(column::definition<costly>(std::ref(nevaluated)),
+                                   {{"again", column::definition<costly>(std::ref(nevaluated))}})(entry));
+    auto tight = loose.filter(column::expression([](column::observable<unsigned long long> i)
+                                                 { return i.value() % 10 == 1; }))(entry);
+    auto x_tight = df.get(query::output<qty::wsum>()).fill(x).at(tight);
+    CHECK(x_tight.nominal().result() == 10 * 99 * 100 / 2 + 100);
+    CHECK(x_tight.variation("again").result() == 10 * 99 * 100 / 2 + 100);
+
+    // positions among the nominal selections
+    auto reorderings = df.get_reorderings();
+    REQUIRE(reorderings.size() == 1);
+    REQUIRE(reorderings[0].size() == 1);
+    CHECK(reorderings[0][0].order == std::vector<size_t>{1, 0});
+}
+
+TEST_CASE("chained cuts are sampled only for the entries reaching them")
+{
+    dataflow df(dataset::reorder(100));
+    auto ds = df.load(dataset::input<entries>(4, 250));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+    auto x = df.define(column::expression([](column::observable<unsigned long long> i)
+                                          { return double(i.value()); }))(entry);
+
+    // a quarter of the entries reach the chain
+    auto quarter = df.filter(column::expression([](column::observable<unsigned long long> i)
+                                                { return i.value() % 4 == 0; }))(entry);
+    unsigned long long nevaluated = 0;
+    auto loose = quarter.filter(df.define(column::definition<costly>(std::ref(nevaluated)))(entry));
+    auto tight = loose.filter(column::expression([](column::observable<unsigned long long> i)
+                                                 { return i.value() % 3 == 0; }))(entry);
+
+    auto x_quarter = df.get(query::output<qty::wsum>()).fill(x).at(quarter);
+    auto x_tight = df.get(query::output<qty::wsum>()).fill(x).at(tight);
+
+    double expected = 0;
+    for (unsigned long long i = 0; i < 1000; ++i)
+    {
+        if (i % 12 == 0 && i % 10 != 0)
+            expected += i;
+    }
+    CHECK(x_quarter.result() == 4 * 249 * 250 / 2);
+    CHECK(x_tight.result() == expected);
+
+    auto reorderings = df.get_reorderings();
+    REQUIRE(reorderings.size() == 1);
+    REQUIRE(reorderings[0].size() == 1);
+    auto const &reordered = reorderings[0][0];
+    CHECK(reordered.order == std::vector<size_t>{2, 1});
+    // measured over the 25 of the first 100 entries that passed the quarter
+    CHECK(reordered.rates[0] == doctest::Approx(9.0 / 25));
+    CHECK(reordered.rates[1] == doctest::Approx(20.0 / 25));
+    // the expensive cut is evaluated for the sampled entries reaching it, then
+    // only for those passing the cheap cut
+    CHECK(nevaluated == 25 + 75);
+}
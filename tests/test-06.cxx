@@ -0,0 +1,94 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <queryosity.hpp>
+
+#include <queryosity/wsum.hpp>
+
+using dataflow = qty::dataflow;
+namespace multithread = qty::multithread;
+namespace dataset = qty::dataset;
+namespace column = qty::column;
+namespace query = qty::query;
+
+// dataset of entry numbers
+class entries : public dataset::reader<entries>
+{
+public:
+    class number : public column::reader<unsigned long long>
+    {
+    public:
+        virtual const unsigned long long &read(unsigned int, unsigned long long entry) const override
+        {
+            m_entry = entry;
+            return m_entry;
+        }
+
+    protected:
+        mutable unsigned long long m_entry;
+    };
+
+public:
+    entries(unsigned long long nentries) : m_nentries(nentries) {}
+
+    virtual void parallelize(unsigned int) override {}
+
+    virtual std::vector<std::pair<unsigned long long, unsigned long long>> partition() override
+    {
+        return {{0, m_nentries}};
+    }
+
+    template <typename T>
+    std::unique_ptr<number> read(unsigned int, const std::string &) const
+    {
+        return std::make_unique<number>();
+    }
+
+protected:
+    unsigned long long m_nentries;
+};
+
+// time the processing of a chain of 1k cheap columns, each one needed by the next
+double time_chain(bool evaluate)
+{
+    const unsigned long long ncolumns = 1000;
+    const unsigned long long nentries = 20000;
+
+    dataflow df;
+    auto ds = df.load(dataset::input<entries>(nentries));
+    auto entry = ds.read(dataset::column<unsigned long long>("entry"));
+
+    // if not evaluated, only the last column is computed for each entry
+    auto increment = column::expression([evaluate](column::observable<double> x)
+                                        { return evaluate ? x.value() + 1.0 : 1.0; });
+    std::vector<decltype(df.define(increment)(entry))> columns;
+    columns.push_back(df.define(increment)(entry));
+    for (unsigned long long icol = 1; icol < ncolumns; ++icol)
+    {
+        columns.push_back(df.define(increment)(columns.back()));
+    }
+
+    auto all = df.filter(column::constant(true));
+    auto sum = df.get(query::output<qty::wsum>()).fill(columns.back()).at(all);
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = sum.result();
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+    CHECK(result == (evaluate ? double(nentries * (nentries - 1) / 2 + nentries * ncolumns) : double(nentries)));
+
+    std::cout << (evaluate ? "evaluated " : "executed ") << nentries << " entries of " << ncolumns << " columns in "
+              << elapsed.count() / 1e6 << " ms ("
+              << elapsed.count() / (nentries * ncolumns) << " ns per column per entry)" << std::endl;
+    return elapsed.count();
+}
+
+TEST_CASE("per-entry overhead of a 1k-column graph")
+{
+    SUBCASE("execution of columns") { time_chain(false); }
+    SUBCASE("evaluation of columns") { time_chain(true); }
+}